@@ -19,6 +19,7 @@
 #             total amount transferred);
 #           - the node map (i.e., a mapping between address identifiers used in the original transfer list 
 #             and those used for nodes);
+#     and the binary version of the node map (used by the tools to write addresses instead of node identifiers).
 #           
 #   -   The script outputs a TSV file describing the main characteristics of the collapsed graph for each contract.
 #       The file contains one row per contract with the following fields:  
@@ -33,6 +34,7 @@
 NAMES=("frax" "esd" "fei" "ampl" "ust")
 COLLAPSED_BUILDER="CollapsedGraphBuilder"
 WEBGRAPH_BUILDER="WebGraphBuilder"
+NODE_MAP_BUILDER="./nm_build"
 INPUT_PATH="./data"
 COLLAPSED_OUTPUT_PATH="./results/cg"
 WEBGRAPH_OUTPUT_PATH="./results/webgraph"
@@ -48,6 +50,7 @@ for NAME in ${NAMES[@]}; do
     NODE_MAP_FILE="${COLLAPSED_OUTPUT_PATH}/${NAME}_cg_nm.tsv"
     printf "%s\t" ${NAME} >> ${OUTPUT_FILE}
     java -Xmx128g ${COLLAPSED_BUILDER} ${INPUT_FILE} ${EDGE_LIST_FILE} ${NODE_MAP_FILE} >> ${OUTPUT_FILE}
+    ${NODE_MAP_BUILDER} "${COLLAPSED_OUTPUT_PATH}/${NAME}_cg_nm.bin" ${NODE_MAP_FILE} > /dev/null
     # Then, transform each edge list into the WebGraph BVGraph format.
     WEBGRAPH_TEMP_EL="${WEBGRAPH_OUTPUT_PATH}/${NAME}_temp_el.tsv"
     cut -d$'\t' -f1,2 "${EDGE_LIST_FILE}" > "${WEBGRAPH_TEMP_EL}"
@@ -11,6 +11,9 @@
 #   -   A set of CSV files, each containing a contiguous chunk of the original contract transfer list.
 #   -   A TSV file containing the mapping between the numeric chunk identifiers and 
 #       the inital timestamp of the chunk time range.
+#   -   The collapsed graph of each chunk, with its node map (also in binary format).
+#   -   A global binary node map including the addresses of all chunks, used to translate
+#       the results of the chunks into a common identifier space (see nm_remap).
 #   
 #   Author: Matteo Loporchio
 #
@@ -19,12 +22,20 @@ NAMES=("frax" "esd" "fei" "ampl" "ust")
 INPUT_PATH="./data"
 OUTPUT_PATH="./results/temporal"
 TIMESTAMP_FILE="data/block_timestamps_0-14999999.csv"
-CHUNK_BUILDER="temporal_builder.py"
+TIMESTAMP_INDEX="data/block_timestamps_0-14999999.bin"
+INDEX_BUILDER="./ts_index"
+CHUNK_BUILDER="./temporal_chunker"
 CHUNK_SIZE="1m"
 COLLAPSED_BUILDER="CollapsedGraphBuilder"
+NODE_MAP_BUILDER="./nm_build"
 
 mkdir -p "${OUTPUT_PATH}"
 
+# Convert the block timestamps into a binary index (only needed once).
+if [ ! -f "${TIMESTAMP_INDEX}" ]; then
+    ${INDEX_BUILDER} ${TIMESTAMP_FILE} ${TIMESTAMP_INDEX} > /dev/null
+fi
+
 for NAME in ${NAMES[@]}; do
     INPUT_FILE="${INPUT_PATH}/${NAME}.csv"
     CHUNK_OUTPUT_PATH="${OUTPUT_PATH}/${NAME}"
@@ -33,7 +44,7 @@ for NAME in ${NAMES[@]}; do
     # Create the chunks.
     CHUNK_BASE_NAME="${CHUNK_OUTPUT_PATH}/${NAME}_chunk"
     CHUNK_MAP_FILE="${CHUNK_OUTPUT_PATH}/${NAME}_chunk_map.tsv"
-    NUM_CHUNKS=$(python3 ${CHUNK_BUILDER} ${INPUT_FILE} ${TIMESTAMP_FILE} ${CHUNK_BASE_NAME} ${CHUNK_MAP_FILE} ${CHUNK_SIZE})
+    NUM_CHUNKS=$(${CHUNK_BUILDER} ${INPUT_FILE} ${TIMESTAMP_INDEX} ${CHUNK_BASE_NAME} ${CHUNK_MAP_FILE} ${CHUNK_SIZE})
 
     # For each chunk, build the corresponding collapsed graph.
     STATS_FILE="${CHUNK_OUTPUT_PATH}/${NAME}_cg_build_stats.tsv"
@@ -44,5 +55,13 @@ for NAME in ${NAMES[@]}; do
         NODE_MAP_FILE="${CHUNK_OUTPUT_PATH}/${NAME}_chunk_${i}_cg_nm.tsv"
         printf "%s\t" ${i} >> ${STATS_FILE}
         java -Xmx128g ${COLLAPSED_BUILDER} ${CHUNK_FILE} ${EDGE_LIST_FILE} ${NODE_MAP_FILE} >> ${STATS_FILE}
+        ${NODE_MAP_BUILDER} "${CHUNK_OUTPUT_PATH}/${NAME}_chunk_${i}_cg_nm.bin" ${NODE_MAP_FILE} > /dev/null
+    done
+
+    # Build the global node map of the contract from the node maps of all chunks.
+    NODE_MAP_FILES=()
+    for ((i=0; i<${NUM_CHUNKS}; i++)); do
+        NODE_MAP_FILES+=("${CHUNK_OUTPUT_PATH}/${NAME}_chunk_${i}_cg_nm.tsv")
     done
+    ${NODE_MAP_BUILDER} "${CHUNK_OUTPUT_PATH}/${NAME}_global_nm.bin" "${NODE_MAP_FILES[@]}" > /dev/null
 done
\ No newline at end of file
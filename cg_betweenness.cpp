@@ -0,0 +1,358 @@
+/**
+ * @file cg_betweenness.cpp
+ * @author Matteo Loporchio
+ * @date 2025-06-10
+ *
+ *  This program reads the collapsed graph from a file and computes the (normalized)
+ *  betweenness centrality of each node, i.e., the fraction of shortest paths passing
+ *  through the node, averaged over all ordered pairs of distinct nodes.
+ *
+ *  By default, the betweenness is estimated with the sampling algorithm by Riondato and Kornaropoulos:
+ *  for each sample, a pair of nodes (s, t) is chosen uniformly at random, a shortest path from s to t
+ *  (if any) is chosen uniformly at random and the estimate of each internal node of the path is increased.
+ *  The number of samples is fixed in advance (there is no adaptive or progressive sampling) and guarantees that,
+ *  with probability at least 1 - delta, all estimates are within epsilon of the exact values. It depends on
+ *  an upper bound to the vertex diameter of the graph (the number of nodes of the longest shortest path).
+ *  The bound extends the 2-approximation by breadth-first visit to directed graphs: within each strongly
+ *  connected component, a shortest path is not longer than the sum of the eccentricities of any node
+ *  of the component in the two directions, and the bound of the graph is the heaviest path in the DAG
+ *  of the components, where each component weighs its own bound (in nodes).
+ *  Samples are processed in parallel, in chunks of fixed size: each chunk draws from its own random number
+ *  generator, seeded from the seed and the index of the chunk, so that the estimates only depend on the seed
+ *  (and not on the number of threads). Each thread owns a scratch area (distances, number of shortest paths,
+ *  visit queue) that is reused across samples and only reset for the nodes visited by the previous sample.
+ *
+ *  For small graphs, the exact betweenness can be computed with the algorithm by Brandes,
+ *  running the visit from each source in parallel.
+ *
+ *  INPUT:
+ *  The program requires the following arguments:
+ *      1. The path to the weighted edge list for the collapsed graph.
+ *      2. The path to the output file.
+ *      3. The maximum additive error epsilon or "exact" for the exact computation.
+ *      4. (Optional) The probability of failure delta (default: 0.1).
+ *      5. (Optional) The seed for the random number generator (default: 0).
+ *      6. (Optional) The path to the binary node map of the graph (see nm_build.cpp).
+ *
+ *  OUTPUT:
+ *  A TSV file with one line for each node. Each line includes the following fields:
+ *      - numeric identifier of the node;
+ *      - betweenness centrality of the node (estimated or exact).
+ *
+ *  PRINT:
+ *  The program prints the following information to stdout:
+ *      - number of graph nodes;
+ *      - number of graph edges;
+ *      - number of samples (number of sources for the exact computation);
+ *      - elapsed time (in nanoseconds).
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <omp.h>
+#include "graph.hpp"
+#include "nodemap.hpp"
+
+#define DEFAULT_DELTA 0.1 // default probability of failure
+#define SAMPLE_CONSTANT 0.5 // universal constant for the sample size bound
+#define SAMPLE_CHUNK 64 // number of samples drawn from the same random number generator
+
+using namespace std;
+using namespace std::chrono;
+
+/**
+ * @brief Scratch area used by a thread for the visits.
+ *  Distances are set to -1 for all nodes not visited by the current visit.
+ */
+typedef struct {
+    vector<int> dist;
+    vector<double> sigma; // number of shortest paths from the source
+    vector<double> delta; // dependency of the source on each node (exact computation only)
+    vector<int> queue; // visited nodes, in order of distance from the source
+    long queue_size;
+} arena_t;
+
+/**
+ * @brief Initializes a scratch area for a graph with a given number of nodes.
+ */
+static void arena_init(arena_t &a, int num_nodes, bool exact) {
+    a.dist.assign(num_nodes, -1);
+    a.sigma.assign(num_nodes, 0);
+    if (exact) a.delta.assign(num_nodes, 0);
+    a.queue.resize(num_nodes);
+    a.queue_size = 0;
+}
+
+/**
+ * @brief Resets the entries of the scratch area modified by the previous visit.
+ */
+static void arena_reset(arena_t &a) {
+    for (long i = 0; i < a.queue_size; i++) {
+        int u = a.queue[i];
+        a.dist[u] = -1;
+        a.sigma[u] = 0;
+        if (!a.delta.empty()) a.delta[u] = 0;
+    }
+    a.queue_size = 0;
+}
+
+/**
+ * @brief Breadth-first visit from a source counting the number of shortest paths.
+ *  If a target is given (t >= 0), the visit stops once all shortest paths to the target are known.
+ */
+static void bfs(const csr_graph_t &out, int s, int t, arena_t &a) {
+    a.dist[s] = 0;
+    a.sigma[s] = 1;
+    a.queue[a.queue_size++] = s;
+    for (long head = 0; head < a.queue_size; head++) {
+        int u = a.queue[head];
+        if (t >= 0 && a.dist[t] >= 0 && a.dist[u] >= a.dist[t]) break;
+        for (long e = out.offsets[u]; e < out.offsets[u + 1]; e++) {
+            int v = out.targets[e];
+            if (a.dist[v] < 0) {
+                a.dist[v] = a.dist[u] + 1;
+                a.queue[a.queue_size++] = v;
+            }
+            if (a.dist[v] == a.dist[u] + 1) a.sigma[v] += a.sigma[u];
+        }
+    }
+}
+
+/**
+ * @brief Breadth-first visit from a node, restricted to the nodes of its component.
+ *
+ * @param adj the adjacency lists
+ * @param s the source
+ * @param membership component of each node
+ * @param dist distance of each node from the source of its component (-1 if not visited)
+ * @param queue scratch space for the visit
+ * @return the eccentricity of s in its component
+ */
+static int component_eccentricity(const csr_graph_t &adj, int s, const igraph_vector_int_t &membership,
+    vector<int> &dist, vector<int> &queue) {
+    long queue_size = 0;
+    dist[s] = 0;
+    queue[queue_size++] = s;
+    for (long head = 0; head < queue_size; head++) {
+        int u = queue[head];
+        for (long e = adj.offsets[u]; e < adj.offsets[u + 1]; e++) {
+            int v = adj.targets[e];
+            if (dist[v] < 0 && VECTOR(membership)[v] == VECTOR(membership)[s]) {
+                dist[v] = dist[u] + 1;
+                queue[queue_size++] = v;
+            }
+        }
+    }
+    return dist[queue[queue_size - 1]];
+}
+
+/**
+ * @brief Computes an upper bound to the vertex diameter of a directed graph,
+ *  i.e., the number of nodes of its longest shortest path.
+ *
+ * @param graph the graph
+ * @param out the adjacency lists (out-neighbors)
+ * @param in the adjacency lists (in-neighbors)
+ * @return the upper bound
+ */
+static long vertex_diameter_bound(const igraph_t *graph, const csr_graph_t &out, const csr_graph_t &in) {
+    int num_nodes = out.num_nodes;
+    igraph_integer_t num_scc;
+    igraph_vector_int_t membership;
+    igraph_vector_int_init(&membership, 0);
+    igraph_connected_components(graph, &membership, NULL, &num_scc, IGRAPH_STRONG);
+
+    // Bound the number of nodes of a shortest path within each component,
+    // going from any node to the root (first node) of the component and from the root to any node.
+    vector<long> weight(num_scc, -1);
+    vector<int> dist_out(num_nodes, -1), dist_in(num_nodes, -1), queue(num_nodes);
+    for (int u = 0; u < num_nodes; u++) {
+        int c = VECTOR(membership)[u];
+        if (weight[c] >= 0) continue;
+        weight[c] = component_eccentricity(out, u, membership, dist_out, queue)
+            + component_eccentricity(in, u, membership, dist_in, queue) + 1;
+    }
+
+    // Find the heaviest path in the DAG of the components (in topological order).
+    vector<long> indegree(num_scc, 0), heaviest(num_scc, 0);
+    vector<vector<int>> members(num_scc);
+    for (int u = 0; u < num_nodes; u++) {
+        members[VECTOR(membership)[u]].push_back(u);
+        for (long e = out.offsets[u]; e < out.offsets[u + 1]; e++)
+            if (VECTOR(membership)[out.targets[e]] != VECTOR(membership)[u]) indegree[VECTOR(membership)[out.targets[e]]]++;
+    }
+    vector<int> ready;
+    for (int c = 0; c < num_scc; c++) if (!indegree[c]) ready.push_back(c);
+    long bound = 0;
+    while (!ready.empty()) {
+        int c = ready.back();
+        ready.pop_back();
+        long length = heaviest[c] + weight[c];
+        bound = max(bound, length);
+        for (int u : members[c]) {
+            for (long e = out.offsets[u]; e < out.offsets[u + 1]; e++) {
+                int d = VECTOR(membership)[out.targets[e]];
+                if (d == c) continue;
+                heaviest[d] = max(heaviest[d], length);
+                if (!--indegree[d]) ready.push_back(d);
+            }
+        }
+    }
+    igraph_vector_int_destroy(&membership);
+    return min(bound, (long) num_nodes);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 4) {
+        cerr << "Usage: " << argv[0] << " <input_file> <output_file> <epsilon|exact> [delta] [seed] [node_map_file]\n";
+        return 1;
+    }
+    bool exact = !strcmp(argv[3], "exact");
+    double epsilon = exact ? 0 : atof(argv[3]);
+    double delta = (argc > 4) ? atof(argv[4]) : DEFAULT_DELTA;
+    unsigned long seed = (argc > 5) ? strtoul(argv[5], NULL, 10) : 0;
+    if (!exact && (epsilon <= 0 || epsilon >= 1 || delta <= 0 || delta >= 1)) {
+        cerr << "Error: epsilon and delta must be in (0, 1)!\n";
+        return 1;
+    }
+
+    auto start = high_resolution_clock::now();
+
+    // Open the node map (if any), to write addresses instead of node identifiers.
+    node_map_t address_map;
+    node_map_t *map = nm_open_optional(argc, argv, 6, &address_map);
+
+    // Load the graph from the corresponding file.
+    FILE *input_file = fopen(argv[1], "r");
+    if (!input_file) {
+        cerr << "Error: could not open input file!\n";
+        return 1;
+    }
+    igraph_t graph;
+    igraph_vector_t w_ntr; // stores weights (total number of transfers)
+    igraph_vector_t w_amount; // stores weights (total value transferred)
+    igraph_vector_init(&w_ntr, 0);
+    igraph_vector_init(&w_amount, 0);
+    read_collapsed_graph(&graph, &w_ntr, &w_amount, input_file);
+    fclose(input_file);
+
+    // Obtain the number of nodes and edges.
+    igraph_integer_t num_nodes = igraph_vcount(&graph);
+    igraph_integer_t num_edges = igraph_ecount(&graph);
+
+    csr_graph_t out;
+    build_csr(&graph, IGRAPH_OUT, &out);
+    vector<double> betweenness(num_nodes, 0);
+    long num_samples = 0;
+    double num_pairs = ((double) num_nodes) * (num_nodes - 1);
+
+    if (exact) {
+        // Brandes algorithm: each thread accumulates the dependencies of its sources.
+        num_samples = num_nodes;
+        #pragma omp parallel
+        {
+            arena_t a;
+            arena_init(a, num_nodes, true);
+            vector<double> local(num_nodes, 0);
+            #pragma omp for schedule(dynamic, 16)
+            for (int s = 0; s < num_nodes; s++) {
+                bfs(out, s, -1, a);
+                // Visit the nodes in order of non-increasing distance from the source.
+                for (long i = a.queue_size - 1; i > 0; i--) {
+                    int w = a.queue[i];
+                    for (long e = out.offsets[w]; e < out.offsets[w + 1]; e++) {
+                        int v = out.targets[e];
+                        if (a.dist[v] == a.dist[w] + 1)
+                            a.delta[w] += (a.sigma[w] / a.sigma[v]) * (1 + a.delta[v]);
+                    }
+                    local[w] += a.delta[w];
+                }
+                arena_reset(a);
+            }
+            #pragma omp critical
+            for (int u = 0; u < num_nodes; u++) betweenness[u] += local[u];
+        }
+        if (num_pairs > 0) for (int u = 0; u < num_nodes; u++) betweenness[u] /= num_pairs;
+    }
+    else if (num_nodes > 1) {
+        // Backtracking from the target requires the in-neighbors of each node.
+        csr_graph_t in;
+        build_csr(&graph, IGRAPH_IN, &in);
+        long vd = vertex_diameter_bound(&graph, out, in);
+        double log_vd = (vd > 3) ? floor(log2((double) (vd - 2))) : 0;
+        num_samples = (long) ceil((SAMPLE_CONSTANT / (epsilon * epsilon)) * (log_vd + 1 + log(1 / delta)));
+        long num_chunks = (num_samples + SAMPLE_CHUNK - 1) / SAMPLE_CHUNK;
+        vector<long> hits(num_nodes, 0);
+        #pragma omp parallel
+        {
+            arena_t a;
+            arena_init(a, num_nodes, false);
+            uniform_int_distribution<int> node_dist(0, num_nodes - 1);
+            uniform_real_distribution<double> unif(0, 1);
+            #pragma omp for schedule(dynamic, 1)
+            for (long chunk = 0; chunk < num_chunks; chunk++) {
+                mt19937_64 rng(seed + 0x9e3779b97f4a7c15UL * (chunk + 1));
+                node_dist.reset();
+                unif.reset();
+                long last = min(num_samples, (chunk + 1) * SAMPLE_CHUNK);
+                for (long i = chunk * SAMPLE_CHUNK; i < last; i++) {
+                    int s = node_dist(rng);
+                    int t = node_dist(rng);
+                    while (t == s) t = node_dist(rng);
+                    bfs(out, s, t, a);
+                    if (a.dist[t] > 1) {
+                        // Choose a shortest path uniformly at random, going backwards from the target:
+                        // each predecessor v of w is chosen with probability sigma[v] / sigma[w].
+                        int w = t;
+                        while (true) {
+                            double r = unif(rng) * a.sigma[w];
+                            int pred = -1;
+                            for (long e = in.offsets[w]; e < in.offsets[w + 1]; e++) {
+                                int v = in.targets[e];
+                                if (a.dist[v] != a.dist[w] - 1) continue;
+                                pred = v;
+                                r -= a.sigma[v];
+                                if (r < 0) break;
+                            }
+                            if (pred == s) break;
+                            #pragma omp atomic
+                            hits[pred]++;
+                            w = pred;
+                        }
+                    }
+                    arena_reset(a);
+                }
+            }
+        }
+        for (int u = 0; u < num_nodes; u++) betweenness[u] = ((double) hits[u]) / num_samples;
+    }
+
+    // Write the results to the output TSV file.
+    FILE *output_file = fopen(argv[2], "w");
+    if (!output_file) {
+        cerr << "Error: could not open output file!\n";
+        return 1;
+    }
+    fprintf(output_file, "%s\tbetweenness\n", nm_column(map));
+    for (int i = 0; i < num_nodes; i++) fprintf(output_file, "%d\t%.12g\n", nm_label(map, i), betweenness[i]);
+    fclose(output_file);
+
+    // Free the memory occupied by the graph.
+    igraph_destroy(&graph);
+    if (map) nm_close(map);
+    igraph_vector_destroy(&w_ntr);
+    igraph_vector_destroy(&w_amount);
+
+    auto end = high_resolution_clock::now();
+    auto elapsed = duration_cast<nanoseconds>(end - start);
+
+    // Print information about the program execution.
+    cout << num_nodes << '\t' << num_edges << '\t' << num_samples << '\t' << elapsed.count() << '\n';
+    return 0;
+}
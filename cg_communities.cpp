@@ -0,0 +1,573 @@
+/**
+ * @file cg_communities.cpp
+ * @author Matteo Loporchio
+ * @date 2025-05-26
+ *
+ *  This program reads the collapsed graph from a file and detects communities of addresses
+ *  by maximizing the modularity of the undirected graph obtained by ignoring edge directions
+ *  (the weight of an undirected edge is the sum of the weights of the two directed edges).
+ *
+ *  The algorithm is a parallel multi-level Louvain method with the Leiden refinement step.
+ *  Each level consists of three phases:
+ *      1) local moving: nodes are visited in parallel and moved to the neighboring community
+ *         with the largest modularity gain. Community weights are updated with atomic operations,
+ *         without locks;
+ *      2) refinement: each community is split into well-connected sub-communities by merging
+ *         singletons inside the community (communities are refined in parallel);
+ *      3) aggregation: the graph is coarsened in parallel, each refined community becoming a node
+ *         of the next level, whose initial partition is the one found in the local moving phase.
+ *  A sweep of the local moving phase that lowers the modularity (because of concurrent moves) is undone
+ *  and ends the phase. The algorithm stops when the local moving phase cannot improve the partition anymore.
+ *
+ *  INPUT:
+ *  The program requires the following arguments:
+ *      1. The path to the weighted edge list for the collapsed graph.
+ *      2. The path to the output file for the communities.
+ *      3. The path to the output file for the level statistics.
+ *      4. (Optional) The edge weight: "ntr" (total number of transfers),
+ *         "amount" (total amount transferred, default) or "none".
+ *      5. (Optional) The path to the binary node map of the graph (see nm_build.cpp).
+ *
+ *  OUTPUT:
+ *  1) A TSV file with one line for each node. Each line includes the following fields:
+ *      - numeric identifier of the node;
+ *      - identifier of the community of the node at each level (one field per level).
+ *  2) A TSV file with one line for each level. Each line includes the following fields:
+ *      - level number;
+ *      - number of communities;
+ *      - modularity of the partition;
+ *      - elapsed time for the local moving phase (in nanoseconds);
+ *      - elapsed time for the refinement phase (in nanoseconds);
+ *      - elapsed time for the aggregation phase (in nanoseconds).
+ *
+ *  PRINT:
+ *  The program prints the following information to stdout:
+ *      - number of graph nodes;
+ *      - number of graph edges;
+ *      - number of levels;
+ *      - modularity of the final partition;
+ *      - elapsed time (in nanoseconds).
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <utility>
+#include <vector>
+#include "graph.hpp"
+#include "nodemap.hpp"
+
+#define MAX_SWEEPS 50 // maximum number of sweeps in the local moving phase
+#define TOLERANCE 1e-6 // minimum modularity improvement for a new sweep
+
+using namespace std;
+using namespace std::chrono;
+
+/**
+ * @brief Undirected weighted graph processed at each level of the algorithm.
+ *  Self-loops are stored separately: self_loops[i] is the weight of the entry (i, i)
+ *  of the adjacency matrix, i.e., twice the total weight of the self-loops of i
+ *  (including the edges collapsed into i at the previous levels).
+ */
+typedef struct {
+    int num_nodes;
+    vector<long> offsets;
+    vector<int> targets;
+    vector<double> weights;
+    vector<double> self_loops;
+    vector<double> strength; // weighted degree of each node (including self-loops)
+    double total; // total weight of the graph (i.e., twice the sum of the edge weights)
+} level_graph_t;
+
+typedef vector<pair<int, double>> pair_buffer_t;
+
+/**
+ * @brief Sums the weights of the pairs with the same identifier.
+ * @param buf the list of (identifier, weight) pairs
+ * @param len number of pairs in the list
+ * @return the number of distinct identifiers, stored at the beginning of the list
+ */
+static long merge_pairs(pair_buffer_t &buf, long len) {
+    if (len == 0) return 0;
+    sort(buf.begin(), buf.begin() + len, [](const pair<int, double> &a, const pair<int, double> &b) {
+        return a.first < b.first;
+    });
+    long k = 0;
+    for (long i = 1; i < len; i++) {
+        if (buf[i].first == buf[k].first) buf[k].second += buf[i].second;
+        else buf[++k] = buf[i];
+    }
+    return k + 1;
+}
+
+/**
+ * @brief Computes the modularity of a partition.
+ */
+static double modularity(const level_graph_t &g, const vector<int> &comm) {
+    vector<double> tot(g.num_nodes, 0);
+    for (int i = 0; i < g.num_nodes; i++) tot[comm[i]] += g.strength[i];
+    double internal = 0;
+    #pragma omp parallel for schedule(dynamic, 1024) reduction(+:internal)
+    for (int i = 0; i < g.num_nodes; i++) {
+        internal += g.self_loops[i];
+        for (long j = g.offsets[i]; j < g.offsets[i + 1]; j++)
+            if (comm[g.targets[j]] == comm[i]) internal += g.weights[j];
+    }
+    double q = internal / g.total;
+    for (int c = 0; c < g.num_nodes; c++) q -= (tot[c] / g.total) * (tot[c] / g.total);
+    return q;
+}
+
+/**
+ * @brief Relabels the communities with consecutive identifiers starting from zero.
+ * @return the number of communities
+ */
+static int renumber(vector<int> &comm) {
+    vector<int> ids(comm.size(), -1);
+    int next = 0;
+    for (size_t i = 0; i < comm.size(); i++) {
+        if (ids[comm[i]] < 0) ids[comm[i]] = next++;
+        comm[i] = ids[comm[i]];
+    }
+    return next;
+}
+
+/**
+ * @brief Groups the nodes according to their community.
+ *  The members of community c are members[offsets[c]], ..., members[offsets[c+1]-1].
+ */
+static void group_members(const vector<int> &comm, int num_comm, vector<long> &offsets, vector<int> &members) {
+    offsets.assign(num_comm + 1, 0);
+    members.resize(comm.size());
+    for (size_t i = 0; i < comm.size(); i++) offsets[comm[i] + 1]++;
+    for (int c = 0; c < num_comm; c++) offsets[c + 1] += offsets[c];
+    vector<long> next(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < comm.size(); i++) members[next[comm[i]]++] = i;
+}
+
+/**
+ * @brief Local moving phase: moves nodes (in parallel) to the neighboring community
+ *  with the largest modularity gain, until the partition cannot be improved.
+ *  Since nodes are moved concurrently, a sweep may lower the modularity: in this case,
+ *  the moves of the sweep are undone and the phase ends.
+ * @return the total number of moves (excluding the undone ones)
+ */
+static long local_moving(const level_graph_t &g, vector<int> &comm) {
+    int n = g.num_nodes;
+    vector<double> tot(n, 0);
+    vector<int> size(n, 0);
+    for (int i = 0; i < n; i++) {
+        tot[comm[i]] += g.strength[i];
+        size[comm[i]]++;
+    }
+    long total_moves = 0;
+    double prev_q = modularity(g, comm);
+    vector<int> prev_comm;
+    for (int sweep = 0; sweep < MAX_SWEEPS; sweep++) {
+        long moves = 0;
+        prev_comm = comm;
+        #pragma omp parallel reduction(+:moves)
+        {
+            pair_buffer_t buf;
+            #pragma omp for schedule(dynamic, 1024)
+            for (int i = 0; i < n; i++) {
+                long deg = g.offsets[i + 1] - g.offsets[i];
+                if (deg == 0) continue;
+                if ((long) buf.size() < deg) buf.resize(deg);
+                int c_old;
+                #pragma omp atomic read
+                c_old = comm[i];
+                for (long j = g.offsets[i]; j < g.offsets[i + 1]; j++) {
+                    int c;
+                    #pragma omp atomic read
+                    c = comm[g.targets[j]];
+                    buf[j - g.offsets[i]] = make_pair(c, g.weights[j]);
+                }
+                long len = merge_pairs(buf, deg);
+                // Gain of staying in the current community (after removing the node from it).
+                double k_i = g.strength[i];
+                double k_old = 0, tot_old;
+                for (long j = 0; j < len; j++) if (buf[j].first == c_old) k_old = buf[j].second;
+                #pragma omp atomic read
+                tot_old = tot[c_old];
+                int best = c_old;
+                double best_gain = k_old - k_i * (tot_old - k_i) / g.total;
+                for (long j = 0; j < len; j++) {
+                    int c = buf[j].first;
+                    if (c == c_old) continue;
+                    double tot_c;
+                    #pragma omp atomic read
+                    tot_c = tot[c];
+                    double gain = buf[j].second - k_i * tot_c / g.total;
+                    if (gain > best_gain) {
+                        best = c;
+                        best_gain = gain;
+                    }
+                }
+                if (best == c_old) continue;
+                // Two singletons may swap communities forever: only the move towards
+                // the community with the lower identifier is allowed.
+                int size_old, size_best;
+                #pragma omp atomic read
+                size_old = size[c_old];
+                #pragma omp atomic read
+                size_best = size[best];
+                if (size_old == 1 && size_best == 1 && best > c_old) continue;
+                #pragma omp atomic
+                tot[c_old] -= k_i;
+                #pragma omp atomic
+                tot[best] += k_i;
+                #pragma omp atomic
+                size[c_old]--;
+                #pragma omp atomic
+                size[best]++;
+                #pragma omp atomic write
+                comm[i] = best;
+                moves++;
+            }
+        }
+        if (moves == 0) break;
+        double q = modularity(g, comm);
+        if (q < prev_q) {
+            comm.swap(prev_comm);
+            break;
+        }
+        total_moves += moves;
+        if (q - prev_q < TOLERANCE) break;
+        prev_q = q;
+    }
+    return total_moves;
+}
+
+/**
+ * @brief Refinement phase: splits each community into well-connected sub-communities.
+ *  Starting from singletons, each node that is still a singleton is merged (if well-connected
+ *  to its community) with the sub-community of the same community giving the largest modularity gain.
+ *
+ * @param g the graph
+ * @param comm the partition found by the local moving phase (with consecutive identifiers)
+ * @param num_comm the number of communities
+ * @param refined stores the refined partition
+ */
+static void refine(const level_graph_t &g, const vector<int> &comm, int num_comm, vector<int> &refined) {
+    int n = g.num_nodes;
+    vector<long> offsets;
+    vector<int> members;
+    group_members(comm, num_comm, offsets, members);
+    refined.resize(n);
+    vector<double> rtot(n), ext(n);
+    vector<int> rsize(n, 1);
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (int i = 0; i < n; i++) {
+        refined[i] = i;
+        rtot[i] = g.strength[i];
+        // Weight of the edges between i and the rest of its community.
+        double w = 0;
+        for (long j = g.offsets[i]; j < g.offsets[i + 1]; j++)
+            if (comm[g.targets[j]] == comm[i]) w += g.weights[j];
+        ext[i] = w;
+    }
+    // Communities are independent, hence they can be refined in parallel.
+    #pragma omp parallel
+    {
+        pair_buffer_t buf;
+        #pragma omp for schedule(dynamic, 16)
+        for (int c = 0; c < num_comm; c++) {
+            if (offsets[c + 1] - offsets[c] < 2) continue;
+            double tot_c = 0;
+            for (long k = offsets[c]; k < offsets[c + 1]; k++) tot_c += g.strength[members[k]];
+            for (long k = offsets[c]; k < offsets[c + 1]; k++) {
+                int v = members[k];
+                if (refined[v] != v || rsize[v] != 1) continue;
+                double k_v = g.strength[v];
+                double ext_v = ext[v];
+                if (ext_v < k_v * (tot_c - k_v) / g.total) continue;
+                long deg = g.offsets[v + 1] - g.offsets[v];
+                if ((long) buf.size() < deg) buf.resize(deg);
+                long len = 0;
+                for (long j = g.offsets[v]; j < g.offsets[v + 1]; j++) {
+                    int u = g.targets[j];
+                    if (comm[u] == c) buf[len++] = make_pair(refined[u], g.weights[j]);
+                }
+                len = merge_pairs(buf, len);
+                int best = v;
+                double best_gain = 0;
+                for (long j = 0; j < len; j++) {
+                    int s = buf[j].first;
+                    if (s == v) continue;
+                    if (ext[s] < rtot[s] * (tot_c - rtot[s]) / g.total) continue;
+                    double gain = buf[j].second - k_v * rtot[s] / g.total;
+                    if (gain >= best_gain) {
+                        best = s;
+                        best_gain = gain;
+                    }
+                }
+                if (best == v) continue;
+                double k_vs = 0;
+                for (long j = 0; j < len; j++) if (buf[j].first == best) k_vs = buf[j].second;
+                refined[v] = best;
+                rsize[v]--;
+                rsize[best]++;
+                rtot[best] += k_v;
+                ext[best] += ext_v - 2 * k_vs;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Aggregation phase: builds (in parallel) the graph in which each community is a node.
+ *
+ * @param g the graph
+ * @param part the partition (with consecutive identifiers)
+ * @param num_parts the number of communities
+ * @param h stores the aggregated graph
+ */
+static void aggregate(const level_graph_t &g, const vector<int> &part, int num_parts, level_graph_t &h) {
+    vector<long> offsets;
+    vector<int> members;
+    group_members(part, num_parts, offsets, members);
+    h.num_nodes = num_parts;
+    h.offsets.assign(num_parts + 1, 0);
+    h.self_loops.assign(num_parts, 0);
+    h.strength.assign(num_parts, 0);
+    h.total = g.total;
+    // The neighbors of each aggregated node are computed twice: first to count them
+    // (so that the adjacency lists can be allocated), then to store them.
+    for (int pass = 0; pass < 2; pass++) {
+        #pragma omp parallel
+        {
+            pair_buffer_t buf;
+            #pragma omp for schedule(dynamic, 256)
+            for (int s = 0; s < num_parts; s++) {
+                long len = 0;
+                double self = 0, strength = 0;
+                for (long k = offsets[s]; k < offsets[s + 1]; k++) {
+                    int i = members[k];
+                    self += g.self_loops[i];
+                    strength += g.strength[i];
+                    for (long j = g.offsets[i]; j < g.offsets[i + 1]; j++) {
+                        int t = part[g.targets[j]];
+                        if (t == s) self += g.weights[j];
+                        else {
+                            if (len == (long) buf.size()) buf.resize(2 * len + 16);
+                            buf[len++] = make_pair(t, g.weights[j]);
+                        }
+                    }
+                }
+                len = merge_pairs(buf, len);
+                if (pass == 0) {
+                    h.offsets[s + 1] = len;
+                    h.self_loops[s] = self;
+                    h.strength[s] = strength;
+                }
+                else {
+                    for (long j = 0; j < len; j++) {
+                        h.targets[h.offsets[s] + j] = buf[j].first;
+                        h.weights[h.offsets[s] + j] = buf[j].second;
+                    }
+                }
+            }
+        }
+        if (pass == 0) {
+            for (int s = 0; s < num_parts; s++) h.offsets[s + 1] += h.offsets[s];
+            h.targets.resize(h.offsets[num_parts]);
+            h.weights.resize(h.offsets[num_parts]);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc < 4) {
+        cerr << "Usage: " << argv[0] << " <input_file> <output_file> <levels_file> [ntr|amount|none] [node_map_file]\n";
+        return 1;
+    }
+    const char *weight_type = (argc > 4) ? argv[4] : "amount";
+    if (strcmp(weight_type, "ntr") && strcmp(weight_type, "amount") && strcmp(weight_type, "none")) {
+        cerr << "Error: unknown weight type!\n";
+        return 1;
+    }
+
+    auto start = high_resolution_clock::now();
+
+    // Open the node map (if any), to write addresses instead of node identifiers.
+    node_map_t address_map;
+    node_map_t *map = nm_open_optional(argc, argv, 5, &address_map);
+
+    // Load the graph from the corresponding file.
+    FILE *input_file = fopen(argv[1], "r");
+    if (!input_file) {
+        cerr << "Error: could not open input file!\n";
+        return 1;
+    }
+    igraph_t graph;
+    igraph_vector_t w_ntr; // stores weights (total number of transfers)
+    igraph_vector_t w_amount; // stores weights (total value transferred)
+    igraph_vector_init(&w_ntr, 0);
+    igraph_vector_init(&w_amount, 0);
+    read_collapsed_graph(&graph, &w_ntr, &w_amount, input_file);
+    fclose(input_file);
+
+    // Obtain the number of nodes and edges.
+    igraph_integer_t num_nodes = igraph_vcount(&graph);
+    igraph_integer_t num_edges = igraph_ecount(&graph);
+
+    // Build the undirected weighted graph (the weights of u -> v and v -> u are summed).
+    const igraph_vector_t *weights = NULL;
+    if (!strcmp(weight_type, "ntr")) weights = &w_ntr;
+    if (!strcmp(weight_type, "amount")) weights = &w_amount;
+    level_graph_t g;
+    {
+        csr_graph_t all;
+        build_csr(&graph, IGRAPH_ALL, &all);
+        g.num_nodes = num_nodes;
+        g.offsets.assign(num_nodes + 1, 0);
+        g.self_loops.assign(num_nodes, 0);
+        g.strength.assign(num_nodes, 0);
+        for (int pass = 0; pass < 2; pass++) {
+            #pragma omp parallel for schedule(dynamic, 1024)
+            for (int u = 0; u < num_nodes; u++) {
+                long k = (pass == 0) ? 0 : g.offsets[u];
+                double strength = 0, self = 0;
+                for (long i = all.offsets[u]; i < all.offsets[u + 1]; i++) {
+                    int v = all.targets[i];
+                    double w = weights ? VECTOR(*weights)[all.edge_ids[i]] : 1.0;
+                    strength += w;
+                    // A self-loop appears twice in the list of its node.
+                    if (v == u) {
+                        self += w;
+                        continue;
+                    }
+                    bool same = (i > all.offsets[u] && v == all.targets[i - 1]);
+                    if (pass == 0) {
+                        if (!same) k++;
+                    }
+                    else {
+                        if (same) g.weights[k - 1] += w;
+                        else {
+                            g.targets[k] = v;
+                            g.weights[k] = w;
+                            k++;
+                        }
+                    }
+                }
+                if (pass == 0) {
+                    g.offsets[u + 1] = k;
+                    g.self_loops[u] = self;
+                    g.strength[u] = strength;
+                }
+            }
+            if (pass == 0) {
+                for (int u = 0; u < num_nodes; u++) g.offsets[u + 1] += g.offsets[u];
+                g.targets.resize(g.offsets[num_nodes]);
+                g.weights.assign(g.offsets[num_nodes], 0);
+            }
+        }
+        g.total = 0;
+        for (int u = 0; u < num_nodes; u++) g.total += g.strength[u];
+    }
+
+    // Run the algorithm level by level.
+    vector<int> node_map(num_nodes); // node of the current level containing each original node
+    for (int u = 0; u < num_nodes; u++) node_map[u] = u;
+    vector<int> comm(num_nodes);
+    for (int u = 0; u < num_nodes; u++) comm[u] = u;
+    vector<vector<int>> levels;
+    vector<double> level_q;
+    vector<long long> move_time, refine_time, aggregate_time;
+    while (g.total > 0) {
+        auto t0 = high_resolution_clock::now();
+        long moves = local_moving(g, comm);
+        auto t1 = high_resolution_clock::now();
+        if (!levels.empty() && moves == 0) break;
+        int num_comm = renumber(comm);
+        vector<int> level(num_nodes);
+        for (int u = 0; u < num_nodes; u++) level[u] = comm[node_map[u]];
+        levels.push_back(level);
+        level_q.push_back(modularity(g, comm));
+        move_time.push_back(duration_cast<nanoseconds>(t1 - t0).count());
+        if (num_comm == g.num_nodes) {
+            refine_time.push_back(0);
+            aggregate_time.push_back(0);
+            break;
+        }
+        // Refine the partition. If no refined community contains more than one node,
+        // the graph is aggregated according to the unrefined partition.
+        vector<int> refined;
+        refine(g, comm, num_comm, refined);
+        int num_refined = renumber(refined);
+        if (num_refined == g.num_nodes) {
+            refined = comm;
+            num_refined = num_comm;
+        }
+        auto t2 = high_resolution_clock::now();
+        // Aggregate the graph: the initial partition of the next level is the unrefined one.
+        level_graph_t h;
+        aggregate(g, refined, num_refined, h);
+        vector<int> next_comm(num_refined);
+        for (int i = 0; i < g.num_nodes; i++) next_comm[refined[i]] = comm[i];
+        for (int u = 0; u < num_nodes; u++) node_map[u] = refined[node_map[u]];
+        g = h;
+        comm = next_comm;
+        auto t3 = high_resolution_clock::now();
+        refine_time.push_back(duration_cast<nanoseconds>(t2 - t1).count());
+        aggregate_time.push_back(duration_cast<nanoseconds>(t3 - t2).count());
+    }
+    // A graph without edges has a single level where each node is a community.
+    if (levels.empty()) {
+        levels.push_back(vector<int>(node_map));
+        level_q.push_back(0);
+        move_time.push_back(0);
+        refine_time.push_back(0);
+        aggregate_time.push_back(0);
+    }
+    int num_levels = levels.size();
+
+    // Write the communities to the output TSV file.
+    FILE *output_file = fopen(argv[2], "w");
+    if (!output_file) {
+        cerr << "Error: could not open output file!\n";
+        return 1;
+    }
+    fprintf(output_file, "%s", nm_column(map));
+    for (int l = 0; l < num_levels; l++) fprintf(output_file, "\tlevel_%d", l);
+    fprintf(output_file, "\n");
+    for (int i = 0; i < num_nodes; i++) {
+        fprintf(output_file, "%d", nm_label(map, i));
+        for (int l = 0; l < num_levels; l++) fprintf(output_file, "\t%d", levels[l][i]);
+        fprintf(output_file, "\n");
+    }
+    fclose(output_file);
+
+    // Write the level statistics to the corresponding TSV file.
+    FILE *levels_file = fopen(argv[3], "w");
+    if (!levels_file) {
+        cerr << "Error: could not open levels file!\n";
+        return 1;
+    }
+    fprintf(levels_file, "level\tnum_communities\tmodularity\tmove_time\trefine_time\taggregate_time\n");
+    for (int l = 0; l < num_levels; l++) {
+        int num_comm = levels[l].empty() ? 0 : 1 + *max_element(levels[l].begin(), levels[l].end());
+        fprintf(levels_file, "%d\t%d\t%lf\t%lld\t%lld\t%lld\n", l, num_comm, level_q[l],
+        move_time[l], refine_time[l], aggregate_time[l]);
+    }
+    fclose(levels_file);
+
+    // Free the memory occupied by the graph.
+    igraph_destroy(&graph);
+    if (map) nm_close(map);
+    igraph_vector_destroy(&w_ntr);
+    igraph_vector_destroy(&w_amount);
+
+    auto end = high_resolution_clock::now();
+    auto elapsed = duration_cast<nanoseconds>(end - start);
+
+    // Print information about the program execution.
+    cout << num_nodes << '\t'
+        << num_edges << '\t'
+        << num_levels << '\t'
+        << level_q[num_levels - 1] << '\t'
+        << elapsed.count() << '\n';
+    return 0;
+}
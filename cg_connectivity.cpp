@@ -10,6 +10,7 @@
  *
  *  INPUT:
  *  The weighted edge list for the collapsed graph.
+ *  Optionally, the binary node map of the graph (see nm_build.cpp).
  *
  *  OUTPUT:
  *  A TSV file summarizing the connectivity properties of each node.
@@ -31,17 +32,22 @@
 #include <chrono>
 #include <iostream>
 #include "graph.hpp"
+#include "nodemap.hpp"
 
 using namespace std;
 using namespace std::chrono;
 
 int main(int argc, char **argv) {
     if (argc < 3) {
-        cerr << "Usage: " << argv[0] << " <input_file> <output_file>\n";
+        cerr << "Usage: " << argv[0] << " <input_file> <output_file> [node_map_file]\n";
         return 1;
     }
     auto start = high_resolution_clock::now();
 
+    // Open the node map (if any), to write addresses instead of node identifiers.
+    node_map_t address_map;
+    node_map_t *map = nm_open_optional(argc, argv, 3, &address_map);
+
     // Load the graph from the corresponding file.
     FILE *input_file = fopen(argv[1], "r");
     if (!input_file) {
@@ -74,16 +80,17 @@ int main(int argc, char **argv) {
         cerr << "Error: could not open output file!\n";
         return 1;
     }
-    fprintf(output_file, "node_id\twcc_id\tscc_id\n");
+    fprintf(output_file, "%s\twcc_id\tscc_id\n", nm_column(map));
     for (int i = 0; i < num_nodes; i++) {
         int wcc_id = VECTOR(wcc_map)[i];
         int scc_id = VECTOR(scc_map)[i];
-        fprintf(output_file, "%d\t%d\t%d\n", i, wcc_id, scc_id);
+        fprintf(output_file, "%d\t%d\t%d\n", nm_label(map, i), wcc_id, scc_id);
     }
     fclose(output_file);
 
     // Free the memory occupied by the graph.
     igraph_destroy(&graph);
+    if (map) nm_close(map);
     igraph_vector_destroy(&w_ntr);
     igraph_vector_destroy(&w_amount);
     igraph_vector_int_destroy(&wcc_map);
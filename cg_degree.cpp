@@ -10,6 +10,7 @@
  *
  *  INPUT:
  *  The weighted edge list for the collapsed graph.
+ *  Optionally, the binary node map of the graph (see nm_build.cpp).
  *
  *  OUTPUT:
  *  A TSV file summarizing degree and strength properties for each node.
@@ -32,18 +33,23 @@
 #include <chrono>
 #include <iostream>
 #include "graph.hpp"
+#include "nodemap.hpp"
 
 using namespace std;
 using namespace std::chrono;
 
 int main(int argc, char **argv) {
     if (argc < 3) {
-        cerr << "Usage: " << argv[0] << " <input_file> <output_file>\n";
+        cerr << "Usage: " << argv[0] << " <input_file> <output_file> [node_map_file]\n";
         return 1;
     }
     
     auto start = high_resolution_clock::now();
     
+    // Open the node map (if any), to write addresses instead of node identifiers.
+    node_map_t address_map;
+    node_map_t *map = nm_open_optional(argc, argv, 3, &address_map);
+
     // Load the graph from the corresponding file.
     FILE *input_file = fopen(argv[1], "r");
     if (!input_file) {
@@ -85,7 +91,7 @@ int main(int argc, char **argv) {
         cerr << "Error: could not open output file!\n";
         return 1;
     }
-    fprintf(output_file, "node_id\tin_deg\tout_deg\tin_str_ntr\tout_str_ntr\tin_str_amount\tout_str_amount\n");
+    fprintf(output_file, "%s\tin_deg\tout_deg\tin_str_ntr\tout_str_ntr\tin_str_amount\tout_str_amount\n", nm_column(map));
     for (int i = 0; i < num_nodes; i++) {
         int in_deg = VECTOR(in_deg_v)[i];
         int out_deg = VECTOR(out_deg_v)[i];
@@ -93,13 +99,14 @@ int main(int argc, char **argv) {
         double out_str_ntr = VECTOR(out_str_ntr_v)[i];
         double in_str_amount = VECTOR(in_str_amount_v)[i];
         double out_str_amount = VECTOR(out_str_amount_v)[i];
-        fprintf(output_file, "%d\t%d\t%d\t%lf\t%lf\t%lf\t%lf\n", i, in_deg, out_deg, 
+        fprintf(output_file, "%d\t%d\t%d\t%lf\t%lf\t%lf\t%lf\n", nm_label(map, i), in_deg, out_deg, 
         in_str_ntr, out_str_ntr, in_str_amount, out_str_amount);
     }
     fclose(output_file);
 
     // Free the memory occupied by the graph.
     igraph_destroy(&graph);
+    if (map) nm_close(map);
     igraph_vector_destroy(&w_ntr);
     igraph_vector_destroy(&w_amount);
     igraph_vector_int_destroy(&in_deg_v);
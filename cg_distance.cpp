@@ -2,35 +2,87 @@
  * @file cg_distance.cpp
  * @author Matteo Loporchio
  * @date 2025-03-06
- * 
- *  This program reads the collapsed graph from a file and computes 
- *  the average shortest path length between all pairs of nodes.
+ *
+ *  This program reads the collapsed graph from a file and computes
+ *  the average shortest path length between all pairs of nodes
+ *  (considering only the pairs where the second node is reachable from the first one).
+ *
+ *  The distances are computed with a breadth-first visit from each source node.
+ *  Sources are processed in parallel, in batches: if a checkpoint file is given, the program periodically
+ *  saves the processed sources, the sum of the distances and the number of reachable pairs found so far,
+ *  and a restarted program resumes from the last checkpoint. The computation can also be restricted to
+ *  a range of sources, so that different ranges can be processed by independent programs and merged with cg_merge.
  *
  *  INPUT:
- *  The weighted edge list for the collapsed graph.
+ *  The program requires the following arguments:
+ *      1. The path to the weighted edge list for the collapsed graph.
+ *      2. (Optional) The path to the checkpoint file.
+ *      3. (Optional) The first source of the range to be processed (default: 0).
+ *      4. (Optional) The last source of the range to be processed, excluded (default: number of nodes).
  *
  *  PRINT:
  *  The program prints the following information to stdout:
  *      - number of graph nodes;
  *      - number of graph edges;
- *      - average shortest path length of the graph;
+ *      - average shortest path length of the graph (for the processed sources);
  *      - elapsed time (in nanoseconds).
  */
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
+#include <vector>
+#include <omp.h>
+#include "checkpoint.hpp"
 #include "graph.hpp"
 
+#define BATCH_SIZE 256 // number of sources processed by each thread between two checkpoints
+#define CHECKPOINT_INTERVAL 600 // minimum time between two checkpoints (in seconds)
+
 using namespace std;
 using namespace std::chrono;
 
+/**
+ * @brief Breadth-first visit from a source, computing the sum of the distances to the reachable nodes.
+ *  The distances of the visited nodes are reset before returning.
+ *
+ * @param out the adjacency lists (out-neighbors)
+ * @param s the source
+ * @param dist distance of each node from s (-1 if not visited)
+ * @param queue visited nodes, in order of distance
+ * @param num_reached stores the number of nodes reachable from s (excluding s)
+ * @return the sum of the distances from s
+ */
+static long sum_distances(const csr_graph_t &out, int s, vector<int> &dist, vector<int> &queue, long &num_reached) {
+    long sum = 0, queue_size = 0;
+    dist[s] = 0;
+    queue[queue_size++] = s;
+    for (long head = 0; head < queue_size; head++) {
+        int u = queue[head];
+        sum += dist[u];
+        for (long e = out.offsets[u]; e < out.offsets[u + 1]; e++) {
+            int v = out.targets[e];
+            if (dist[v] < 0) {
+                dist[v] = dist[u] + 1;
+                queue[queue_size++] = v;
+            }
+        }
+    }
+    for (long i = 0; i < queue_size; i++) dist[queue[i]] = -1;
+    num_reached = queue_size - 1;
+    return sum;
+}
+
 int main(int argc, char **argv) {
     if (argc < 2) {
-        cerr << "Usage: " << argv[0] << " <input_file>\n";
+        cerr << "Usage: " << argv[0] << " <input_file> [checkpoint_file [begin [end]]]\n";
         return 1;
     }
+    const char *checkpoint_path = (argc > 2) ? argv[2] : NULL;
     auto start = high_resolution_clock::now();
-    
+
     // Load the graph from the corresponding file.
     FILE *input_file = fopen(argv[1], "r");
     if (!input_file) {
@@ -48,24 +100,93 @@ int main(int argc, char **argv) {
     // Obtain the number of nodes and edges.
     igraph_integer_t num_nodes = igraph_vcount(&graph);
     igraph_integer_t num_edges = igraph_ecount(&graph);
+    csr_graph_t out;
+    build_csr(&graph, IGRAPH_OUT, &out);
+    long begin = (argc > 3) ? atol(argv[3]) : 0;
+    long end = (argc > 4) ? atol(argv[4]) : num_nodes;
+    if (argc > 3 && (begin < 0 || begin >= end || end > num_nodes)) {
+        cerr << "Error: invalid range of sources!\n";
+        return 1;
+    }
+
+    // Resume the computation from the checkpoint (if any).
+    // The accumulators are the sum of the distances and the number of reachable pairs.
+    checkpoint_t ckpt;
+    ckpt.kind = CKPT_DISTANCE;
+    ckpt.num_nodes = num_nodes;
+    ckpt.num_edges = num_edges;
+    ckpt.fingerprint = graph_fingerprint(&out);
+    ckpt.values.assign(2, 0);
+    checkpoint_t saved;
+    int status = checkpoint_path ? ckpt_read(checkpoint_path, &saved) : -1;
+    if (status == -2) {
+        cerr << "Error: invalid checkpoint file!\n";
+        return 1;
+    }
+    if (status == 0) {
+        if (saved.kind != ckpt.kind || saved.num_nodes != ckpt.num_nodes || saved.num_edges != ckpt.num_edges
+            || saved.fingerprint != ckpt.fingerprint || saved.values.size() != 2) {
+            cerr << "Error: the checkpoint does not match the graph!\n";
+            return 1;
+        }
+        ckpt = saved;
+    }
+
+    // Visit the graph from each source, in batches.
+    int num_threads = omp_get_max_threads();
+    long batch_size = (long) BATCH_SIZE * num_threads;
+    vector<vector<int>> dist(num_threads), queue(num_threads);
+    auto last_checkpoint = steady_clock::now();
+    for (const pair<int64_t, int64_t> &range : ckpt_missing(&ckpt, begin, end)) {
+        for (long first = range.first; first < range.second; first += batch_size) {
+            long last = min(first + batch_size, (long) range.second);
+            long sum = 0, num_pairs = 0;
+            #pragma omp parallel reduction(+:sum, num_pairs)
+            {
+                int t = omp_get_thread_num();
+                if (dist[t].empty()) {
+                    dist[t].assign(num_nodes, -1);
+                    queue[t].resize(num_nodes);
+                }
+                #pragma omp for schedule(dynamic, 16)
+                for (long s = first; s < last; s++) {
+                    long num_reached;
+                    sum += sum_distances(out, s, dist[t], queue[t], num_reached);
+                    num_pairs += num_reached;
+                }
+            }
+            ckpt.values[0] += sum;
+            ckpt.values[1] += num_pairs;
+            ckpt_add_range(&ckpt, first, last);
+            if (checkpoint_path && steady_clock::now() - last_checkpoint >= seconds(CHECKPOINT_INTERVAL)) {
+                if (ckpt_write(checkpoint_path, &ckpt) < 0) {
+                    cerr << "Error: could not write checkpoint file!\n";
+                    return 1;
+                }
+                last_checkpoint = steady_clock::now();
+            }
+        }
+    }
+    if (checkpoint_path && ckpt_write(checkpoint_path, &ckpt) < 0) {
+        cerr << "Error: could not write checkpoint file!\n";
+        return 1;
+    }
 
     // Compute the average shortest path length of the graph.
-    igraph_real_t avg_distance;
-    igraph_average_path_length(&graph, &avg_distance, NULL, IGRAPH_DIRECTED, 1);
+    double avg_distance = (ckpt.values[1] > 0) ? ckpt.values[0] / ckpt.values[1] : NAN;
 
     // Free the memory occupied by the graph.
     igraph_destroy(&graph);
     igraph_vector_destroy(&w_ntr);
     igraph_vector_destroy(&w_amount);
 
-    auto end = high_resolution_clock::now();
-    auto elapsed = duration_cast<nanoseconds>(end - start);
+    auto stop = high_resolution_clock::now();
+    auto elapsed = duration_cast<nanoseconds>(stop - start);
 
-    // Print information about the program execution. 
-    cout << num_nodes << '\t' 
-        << num_edges << '\t' 
-        << avg_distance << '\t' 
+    // Print information about the program execution.
+    cout << num_nodes << '\t'
+        << num_edges << '\t'
+        << avg_distance << '\t'
         << elapsed.count() << '\n';
     return 0;
 }
-
@@ -2,19 +2,31 @@
  * @file cg_harmonic.cpp
  * @author Matteo Loporchio
  * @date 2025-03-06
- * 
+ *
  *  This program reads the collapsed graph from a file and computes the harmonic centrality
- *  for all nodes.
+ *  for all nodes, i.e., the sum of the inverse distances from all other nodes to the node.
+ *
+ *  The harmonic centrality of each node is computed with a breadth-first visit of the graph
+ *  following the edges backwards. Nodes are processed in parallel, in batches: if a checkpoint file
+ *  is given, the program periodically saves the processed nodes and their centrality, and a restarted
+ *  program resumes from the last checkpoint. The computation can also be restricted to a range of nodes,
+ *  so that different ranges can be processed by independent programs and merged with cg_merge.
  *
  *  INPUT:
- *  The weighted edge list for the collapsed graph.
+ *  The program requires the following arguments:
+ *      1. The path to the weighted edge list for the collapsed graph.
+ *      2. The path to the output file.
+ *      3. (Optional) The path to the binary node map of the graph (see nm_build.cpp) or "-".
+ *      4. (Optional) The path to the checkpoint file.
+ *      5. (Optional) The first node of the range to be processed (default: 0).
+ *      6. (Optional) The last node of the range to be processed, excluded (default: number of nodes).
  *
  *  OUTPUT:
  *  A TSV file summarizing the harmonic centrality for each node.
  *  The file contains one line for each node. Each line includes the following fields:
  *      - numeric identifier of the node;
- *      - harmonic centrality of the node.
- * 
+ *      - harmonic centrality of the node (0 if the node has not been processed).
+ *
  *  PRINT:
  *  The program prints the following information to stdout:
  *      - number of graph nodes;
@@ -22,23 +34,65 @@
  *      - elapsed time (in nanoseconds).
  */
 
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
 #include <iostream>
+#include <vector>
+#include <omp.h>
+#include "checkpoint.hpp"
 #include "graph.hpp"
+#include "nodemap.hpp"
 
-#define DAMPING_FACTOR 0.85 // This is the default damping factor for PageRank
+#define BATCH_SIZE 256 // number of nodes processed by each thread between two checkpoints
+#define CHECKPOINT_INTERVAL 600 // minimum time between two checkpoints (in seconds)
 
 using namespace std;
 using namespace std::chrono;
 
+/**
+ * @brief Computes the harmonic centrality of a node with a breadth-first visit.
+ *  The distances of the visited nodes are reset before returning.
+ *
+ * @param in the adjacency lists (in-neighbors)
+ * @param v the node
+ * @param dist distance of each node from v (-1 if not visited)
+ * @param queue visited nodes, in order of distance
+ * @return the harmonic centrality of v
+ */
+static double harmonic_centrality(const csr_graph_t &in, int v, vector<int> &dist, vector<int> &queue) {
+    double sum = 0;
+    long queue_size = 0;
+    dist[v] = 0;
+    queue[queue_size++] = v;
+    for (long head = 0; head < queue_size; head++) {
+        int u = queue[head];
+        if (dist[u] > 0) sum += 1.0 / dist[u];
+        for (long e = in.offsets[u]; e < in.offsets[u + 1]; e++) {
+            int w = in.targets[e];
+            if (dist[w] < 0) {
+                dist[w] = dist[u] + 1;
+                queue[queue_size++] = w;
+            }
+        }
+    }
+    for (long i = 0; i < queue_size; i++) dist[queue[i]] = -1;
+    return sum;
+}
+
 int main(int argc, char **argv) {
     if (argc < 3) {
-        cerr << "Usage: " << argv[0] << " <input_file> <output_file>\n";
+        cerr << "Usage: " << argv[0] << " <input_file> <output_file> [node_map_file|-] [checkpoint_file [begin [end]]]\n";
         return 1;
     }
-    
+    const char *checkpoint_path = (argc > 4) ? argv[4] : NULL;
+
     auto start = high_resolution_clock::now();
-    
+
+    // Open the node map (if any), to write addresses instead of node identifiers.
+    node_map_t address_map;
+    node_map_t *map = nm_open_optional(argc, argv, 3, &address_map);
+
     // Load the graph from the corresponding file.
     FILE *input_file = fopen(argv[1], "r");
     if (!input_file) {
@@ -56,11 +110,70 @@ int main(int argc, char **argv) {
     // Obtain the number of nodes and edges.
     igraph_integer_t num_nodes = igraph_vcount(&graph);
     igraph_integer_t num_edges = igraph_ecount(&graph);
+    csr_graph_t in;
+    build_csr(&graph, IGRAPH_IN, &in);
+    long begin = (argc > 5) ? atol(argv[5]) : 0;
+    long end = (argc > 6) ? atol(argv[6]) : num_nodes;
+    if (argc > 5 && (begin < 0 || begin >= end || end > num_nodes)) {
+        cerr << "Error: invalid range of nodes!\n";
+        return 1;
+    }
 
-    // Compute the harmonic centrality.
-    igraph_vector_t harmonic;
-    igraph_vector_init(&harmonic, num_nodes);
-    igraph_harmonic_centrality(&graph, &harmonic, igraph_vss_all(), IGRAPH_IN, NULL, 0);
+    // Resume the computation from the checkpoint (if any).
+    checkpoint_t ckpt;
+    ckpt.kind = CKPT_HARMONIC;
+    ckpt.num_nodes = num_nodes;
+    ckpt.num_edges = num_edges;
+    ckpt.fingerprint = graph_fingerprint(&in);
+    ckpt.values.assign(num_nodes, 0);
+    checkpoint_t saved;
+    int status = checkpoint_path ? ckpt_read(checkpoint_path, &saved) : -1;
+    if (status == -2) {
+        cerr << "Error: invalid checkpoint file!\n";
+        return 1;
+    }
+    if (status == 0) {
+        if (saved.kind != ckpt.kind || saved.num_nodes != ckpt.num_nodes || saved.num_edges != ckpt.num_edges
+            || saved.fingerprint != ckpt.fingerprint || (long) saved.values.size() != num_nodes) {
+            cerr << "Error: the checkpoint does not match the graph!\n";
+            return 1;
+        }
+        ckpt = saved;
+    }
+
+    // Compute the harmonic centrality of the nodes in batches.
+    int num_threads = omp_get_max_threads();
+    long batch_size = (long) BATCH_SIZE * num_threads;
+    vector<vector<int>> dist(num_threads), queue(num_threads);
+    auto last_checkpoint = steady_clock::now();
+    for (const pair<int64_t, int64_t> &range : ckpt_missing(&ckpt, begin, end)) {
+        for (long first = range.first; first < range.second; first += batch_size) {
+            long last = min(first + batch_size, (long) range.second);
+            #pragma omp parallel
+            {
+                int t = omp_get_thread_num();
+                if (dist[t].empty()) {
+                    dist[t].assign(num_nodes, -1);
+                    queue[t].resize(num_nodes);
+                }
+                #pragma omp for schedule(dynamic, 16)
+                for (long v = first; v < last; v++)
+                    ckpt.values[v] = harmonic_centrality(in, v, dist[t], queue[t]);
+            }
+            ckpt_add_range(&ckpt, first, last);
+            if (checkpoint_path && steady_clock::now() - last_checkpoint >= seconds(CHECKPOINT_INTERVAL)) {
+                if (ckpt_write(checkpoint_path, &ckpt) < 0) {
+                    cerr << "Error: could not write checkpoint file!\n";
+                    return 1;
+                }
+                last_checkpoint = steady_clock::now();
+            }
+        }
+    }
+    if (checkpoint_path && ckpt_write(checkpoint_path, &ckpt) < 0) {
+        cerr << "Error: could not write checkpoint file!\n";
+        return 1;
+    }
 
     // Write the results to the output TSV file.
     FILE *output_file = fopen(argv[2], "w");
@@ -68,26 +181,23 @@ int main(int argc, char **argv) {
         cerr << "Error: could not open output file!\n";
         return 1;
     }
-    fprintf(output_file, "node_id\tharmonic\n");
+    fprintf(output_file, "%s\tharmonic\n", nm_column(map));
     for (int i = 0; i < num_nodes; i++) {
-        double h = VECTOR(harmonic)[i];
-        fprintf(output_file, "%d\t%lf\n", i, h); 
+        double h = ckpt.values[i];
+        fprintf(output_file, "%d\t%lf\n", nm_label(map, i), h);
     }
     fclose(output_file);
 
     // Free the memory occupied by the graph.
     igraph_destroy(&graph);
+    if (map) nm_close(map);
     igraph_vector_destroy(&w_ntr);
     igraph_vector_destroy(&w_amount);
-    igraph_vector_destroy(&harmonic);
-    //igraph_vector_destroy(&harmonic_ntr);
-    //igraph_vector_destroy(&pagerank_amount);
-    
-    auto end = high_resolution_clock::now();
-    auto elapsed = duration_cast<nanoseconds>(end - start);
 
-    // Print information about the program execution. 
+    auto stop = high_resolution_clock::now();
+    auto elapsed = duration_cast<nanoseconds>(stop - start);
+
+    // Print information about the program execution.
     cout << num_nodes << '\t' << num_edges << '\t' << elapsed.count() << '\n';
     return 0;
 }
-
@@ -16,6 +16,7 @@
  *
  *  INPUT:
  *  The weighted edge list for the collapsed graph.
+ *  Optionally, the binary node map of the graph (see nm_build.cpp).
  *
  *  OUTPUT:
  *  A TSV file summarizing the Hub and Authority scores for each node.
@@ -38,18 +39,23 @@
 #include <chrono>
 #include <iostream>
 #include "graph.hpp"
+#include "nodemap.hpp"
 
 using namespace std;
 using namespace std::chrono;
 
 int main(int argc, char **argv) {
     if (argc < 3) {
-        cerr << "Usage: " << argv[0] << " <input_file> <output_file>\n";
+        cerr << "Usage: " << argv[0] << " <input_file> <output_file> [node_map_file]\n";
         return 1;
     }
     
     auto start = high_resolution_clock::now();
     
+    // Open the node map (if any), to write addresses instead of node identifiers.
+    node_map_t address_map;
+    node_map_t *map = nm_open_optional(argc, argv, 3, &address_map);
+
     // Load the graph from the corresponding file.
     FILE *input_file = fopen(argv[1], "r");
     if (!input_file) {
@@ -86,7 +92,7 @@ int main(int argc, char **argv) {
         cerr << "Error: could not open output file!\n";
         return 1;
     }
-    fprintf(output_file, "node_id\thub\thub_ntr\thub_amount\tauth\tauth_ntr\tauth_amount\n");
+    fprintf(output_file, "%s\thub\thub_ntr\thub_amount\tauth\tauth_ntr\tauth_amount\n", nm_column(map));
     for (int i = 0; i < num_nodes; i++) {
         double h = VECTOR(hs)[i];
         double h_ntr = VECTOR(hs_ntr)[i];
@@ -94,13 +100,14 @@ int main(int argc, char **argv) {
         double a = VECTOR(as)[i];
         double a_ntr = VECTOR(as_ntr)[i];
         double a_amount = VECTOR(as_amount)[i];
-        fprintf(output_file, "%d\t%lf\t%lf\t%lf\t%lf\t%lf\t%lf\n", i, h, h_ntr, h_amount, a, a_ntr, a_amount);
+        fprintf(output_file, "%d\t%lf\t%lf\t%lf\t%lf\t%lf\t%lf\n", nm_label(map, i), h, h_ntr, h_amount, a, a_ntr, a_amount);
     }
     // Close the output file.
     fclose(output_file);
 
     // Free the memory occupied by the graph.
     igraph_destroy(&graph);
+    if (map) nm_close(map);
     igraph_vector_destroy(&w_ntr);
     igraph_vector_destroy(&w_amount);
     igraph_vector_destroy(&hs);
@@ -0,0 +1,289 @@
+/**
+ * @file cg_kcore.cpp
+ * @author Matteo Loporchio
+ * @date 2025-06-03
+ *
+ *  This program reads the collapsed graph from a file and computes the core decomposition
+ *  of the graph. The core number of a node is the largest k such that the node belongs to
+ *  a subgraph where all nodes have degree at least k. Core numbers are computed according
+ *  to the in-degree, the out-degree and the total degree (i.e., the sum of the two).
+ *
+ *  Core numbers are computed with a parallel peeling algorithm: at each level k, all nodes
+ *  with degree at most k are removed in parallel, the degrees of their neighbors are decreased
+ *  with atomic operations and the neighbors whose degree drops to k form the next bucket to be removed.
+ *  The remaining nodes are kept in buckets indexed by degree: a node whose degree decreases is moved
+ *  to its new bucket at the end of the level, so that each level only visits its own bucket
+ *  and empty levels are skipped.
+ *
+ *  The program also computes the s-core decomposition, where the degree of a node is replaced
+ *  by its total strength, computed according to the total number of transfers and to the total
+ *  amount transferred. The s-core number of a node is the largest s such that the node belongs
+ *  to a subgraph where all nodes have strength at least s. Since strengths are real numbers,
+ *  the s-core decomposition uses a priority queue (the two weightings are processed in parallel).
+ *
+ *  INPUT:
+ *  The program requires the following arguments:
+ *      1. The path to the weighted edge list for the collapsed graph.
+ *      2. The path to the output file for the core numbers.
+ *      3. The path to the output file for the core size distribution.
+ *      4. (Optional) The path to the binary node map of the graph (see nm_build.cpp).
+ *
+ *  OUTPUT:
+ *  1) A TSV file with one line for each node. Each line includes the following fields:
+ *      - numeric identifier of the node;
+ *      - core number of the node (computed according to the in-degree);
+ *      - core number of the node (computed according to the out-degree);
+ *      - core number of the node (computed according to the total degree);
+ *      - s-core number of the node (computed according to the total number of transfers);
+ *      - s-core number of the node (computed according to the total amount transferred).
+ *  2) A TSV file with one line for each value of k. Each line includes the following fields:
+ *      - value of k;
+ *      - number of nodes in the k-core (computed according to the in-degree);
+ *      - number of nodes in the k-core (computed according to the out-degree);
+ *      - number of nodes in the k-core (computed according to the total degree).
+ *  The distribution of the s-core numbers is not included, since they are real numbers.
+ *
+ *  PRINT:
+ *  The program prints the following information to stdout:
+ *      - number of graph nodes;
+ *      - number of graph edges;
+ *      - maximum core number (computed according to the in-degree);
+ *      - maximum core number (computed according to the out-degree);
+ *      - maximum core number (computed according to the total degree);
+ *      - elapsed time (in nanoseconds).
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <utility>
+#include <vector>
+#include <omp.h>
+#include "graph.hpp"
+#include "nodemap.hpp"
+
+using namespace std;
+using namespace std::chrono;
+
+/**
+ * @brief Computes the core numbers with the parallel peeling algorithm.
+ *
+ * @param deg the degree of each node
+ * @param adj the adjacency lists: removing node u decreases the degree of each node in the list of u
+ * @param core stores the core number of each node
+ * @return the maximum core number
+ */
+static int peel(vector<int> deg, const csr_graph_t &adj, vector<int> &core) {
+    int n = adj.num_nodes;
+    core.assign(n, 0);
+    if (n == 0) return 0;
+    vector<char> removed(n, 0);
+    vector<int> frontier(n), next(n);
+    // Bucket d holds the nodes whose degree was d when they were last inserted:
+    // a node may appear in several buckets, but only the first occurrence is used.
+    int max_deg = *max_element(deg.begin(), deg.end());
+    vector<vector<int>> bucket(max_deg + 1);
+    for (int u = 0; u < n; u++) bucket[deg[u]].push_back(u);
+    vector<vector<int>> moved(omp_get_max_threads());
+    int k = 0;
+    for (int d = 0; d <= max_deg; d++) {
+        // Collect the nodes with degree d, skipping the nodes already removed.
+        long frontier_size = 0;
+        for (int u : bucket[d]) {
+            if (removed[u]) continue;
+            removed[u] = 1;
+            frontier[frontier_size++] = u;
+        }
+        vector<int>().swap(bucket[d]);
+        if (frontier_size == 0) continue;
+        k = d;
+        while (frontier_size > 0) {
+            #pragma omp parallel for
+            for (long i = 0; i < frontier_size; i++) core[frontier[i]] = k;
+            long next_size = 0;
+            #pragma omp parallel
+            {
+                vector<int> &local = moved[omp_get_thread_num()];
+                #pragma omp for schedule(dynamic, 64)
+                for (long i = 0; i < frontier_size; i++) {
+                    int u = frontier[i];
+                    for (long e = adj.offsets[u]; e < adj.offsets[u + 1]; e++) {
+                        int v = adj.targets[e];
+                        if (removed[v]) continue;
+                        int old_deg;
+                        #pragma omp atomic capture
+                        old_deg = deg[v]--;
+                        // The node enters the bucket exactly once, when its degree drops to k.
+                        if (old_deg == k + 1) {
+                            long pos;
+                            #pragma omp atomic capture
+                            pos = next_size++;
+                            next[pos] = v;
+                        }
+                        else if (old_deg > k + 1) local.push_back(v);
+                    }
+                }
+            }
+            for (long i = 0; i < next_size; i++) removed[next[i]] = 1;
+            frontier.swap(next);
+            frontier_size = next_size;
+        }
+        // Move the nodes whose degree decreased (but is still above k) to the bucket of their current degree.
+        for (vector<int> &local : moved) {
+            for (int v : local)
+                if (!removed[v]) bucket[deg[v]].push_back(v);
+            local.clear();
+        }
+    }
+    return k;
+}
+
+/**
+ * @brief Computes the s-core numbers of the undirected graph for a given weight vector.
+ *
+ * @param adj the adjacency lists (both directions)
+ * @param weights the weight of each edge
+ * @param score stores the s-core number of each node
+ */
+static void s_peel(const csr_graph_t &adj, const igraph_vector_t *weights, vector<double> &score) {
+    int n = adj.num_nodes;
+    vector<double> str(n, 0);
+    for (int u = 0; u < n; u++)
+        for (long e = adj.offsets[u]; e < adj.offsets[u + 1]; e++)
+            if (adj.targets[e] != u) str[u] += VECTOR(*weights)[adj.edge_ids[e]];
+    score.assign(n, 0);
+    vector<char> removed(n, 0);
+    // Min-heap of (strength, node) pairs: outdated entries are skipped when extracted.
+    priority_queue<pair<double, int>, vector<pair<double, int>>, greater<pair<double, int>>> heap;
+    for (int u = 0; u < n; u++) heap.push(make_pair(str[u], u));
+    double level = 0;
+    while (!heap.empty()) {
+        pair<double, int> top = heap.top();
+        heap.pop();
+        int u = top.second;
+        if (removed[u] || top.first != str[u]) continue;
+        level = max(level, str[u]);
+        score[u] = level;
+        removed[u] = 1;
+        for (long e = adj.offsets[u]; e < adj.offsets[u + 1]; e++) {
+            int v = adj.targets[e];
+            if (removed[v]) continue;
+            str[v] -= VECTOR(*weights)[adj.edge_ids[e]];
+            heap.push(make_pair(str[v], v));
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc < 4) {
+        cerr << "Usage: " << argv[0] << " <input_file> <output_file> <distribution_file> [node_map_file]\n";
+        return 1;
+    }
+
+    auto start = high_resolution_clock::now();
+
+    // Open the node map (if any), to write addresses instead of node identifiers.
+    node_map_t address_map;
+    node_map_t *map = nm_open_optional(argc, argv, 4, &address_map);
+
+    // Load the graph from the corresponding file.
+    FILE *input_file = fopen(argv[1], "r");
+    if (!input_file) {
+        cerr << "Error: could not open input file!\n";
+        return 1;
+    }
+    igraph_t graph;
+    igraph_vector_t w_ntr; // stores weights (total number of transfers)
+    igraph_vector_t w_amount; // stores weights (total value transferred)
+    igraph_vector_init(&w_ntr, 0);
+    igraph_vector_init(&w_amount, 0);
+    read_collapsed_graph(&graph, &w_ntr, &w_amount, input_file);
+    fclose(input_file);
+
+    // Obtain the number of nodes and edges.
+    igraph_integer_t num_nodes = igraph_vcount(&graph);
+    igraph_integer_t num_edges = igraph_ecount(&graph);
+
+    // Compute the core numbers for the three types of degree.
+    // Removing a node decreases the in-degree of its out-neighbors and vice versa.
+    csr_graph_t out, in, all;
+    build_csr(&graph, IGRAPH_OUT, &out);
+    build_csr(&graph, IGRAPH_IN, &in);
+    build_csr(&graph, IGRAPH_ALL, &all);
+    vector<int> in_deg(num_nodes), out_deg(num_nodes), all_deg(num_nodes);
+    for (int u = 0; u < num_nodes; u++) {
+        in_deg[u] = in.offsets[u + 1] - in.offsets[u];
+        out_deg[u] = out.offsets[u + 1] - out.offsets[u];
+        all_deg[u] = all.offsets[u + 1] - all.offsets[u];
+    }
+    vector<int> core_in, core_out, core_all;
+    int max_in = peel(in_deg, out, core_in);
+    int max_out = peel(out_deg, in, core_out);
+    int max_all = peel(all_deg, all, core_all);
+
+    // Compute the s-core numbers for the two weights.
+    vector<double> score_ntr, score_amount;
+    #pragma omp parallel sections
+    {
+        #pragma omp section
+        s_peel(all, &w_ntr, score_ntr);
+        #pragma omp section
+        s_peel(all, &w_amount, score_amount);
+    }
+
+    // Write the results to the output TSV file.
+    FILE *output_file = fopen(argv[2], "w");
+    if (!output_file) {
+        cerr << "Error: could not open output file!\n";
+        return 1;
+    }
+    fprintf(output_file, "%s\tcore_in\tcore_out\tcore_all\tscore_ntr\tscore_amount\n", nm_column(map));
+    for (int i = 0; i < num_nodes; i++) {
+        fprintf(output_file, "%d\t%d\t%d\t%d\t%lf\t%lf\n", nm_label(map, i), core_in[i], core_out[i], core_all[i],
+        score_ntr[i], score_amount[i]);
+    }
+    fclose(output_file);
+
+    // Write the size of each k-core (i.e., the number of nodes with core number at least k).
+    int max_k = max({max_in, max_out, max_all});
+    vector<long> size_in(max_k + 2, 0), size_out(max_k + 2, 0), size_all(max_k + 2, 0);
+    for (int i = 0; i < num_nodes; i++) {
+        size_in[core_in[i]]++;
+        size_out[core_out[i]]++;
+        size_all[core_all[i]]++;
+    }
+    for (int k = max_k - 1; k >= 0; k--) {
+        size_in[k] += size_in[k + 1];
+        size_out[k] += size_out[k + 1];
+        size_all[k] += size_all[k + 1];
+    }
+    FILE *distribution_file = fopen(argv[3], "w");
+    if (!distribution_file) {
+        cerr << "Error: could not open distribution file!\n";
+        return 1;
+    }
+    fprintf(distribution_file, "k\tsize_in\tsize_out\tsize_all\n");
+    for (int k = 0; k <= max_k; k++)
+        fprintf(distribution_file, "%d\t%ld\t%ld\t%ld\n", k, size_in[k], size_out[k], size_all[k]);
+    fclose(distribution_file);
+
+    // Free the memory occupied by the graph.
+    igraph_destroy(&graph);
+    if (map) nm_close(map);
+    igraph_vector_destroy(&w_ntr);
+    igraph_vector_destroy(&w_amount);
+
+    auto end = high_resolution_clock::now();
+    auto elapsed = duration_cast<nanoseconds>(end - start);
+
+    // Print information about the program execution.
+    cout << num_nodes << '\t'
+        << num_edges << '\t'
+        << max_in << '\t'
+        << max_out << '\t'
+        << max_all << '\t'
+        << elapsed.count() << '\n';
+    return 0;
+}
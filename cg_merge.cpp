@@ -0,0 +1,78 @@
+/**
+ * @file cg_merge.cpp
+ * @author Matteo Loporchio
+ * @date 2025-07-15
+ *
+ *  This program merges the checkpoints produced by independent runs of cg_harmonic
+ *  (or cg_distance) on disjoint ranges of nodes of the same collapsed graph.
+ *  The merged checkpoint can then be given to the original program, which only processes the
+ *  missing nodes (if any) and writes the final results.
+ *
+ *  INPUT:
+ *  The program requires the following arguments:
+ *      1. The path to the merged checkpoint file.
+ *      2. The paths to the checkpoint files to be merged.
+ *
+ *  OUTPUT:
+ *  The merged checkpoint file.
+ *
+ *  PRINT:
+ *  The program prints the following information to stdout:
+ *      - number of graph nodes;
+ *      - number of nodes processed (in all checkpoints);
+ *      - elapsed time (in nanoseconds).
+ */
+
+#include <chrono>
+#include <iostream>
+#include "checkpoint.hpp"
+
+using namespace std;
+using namespace std::chrono;
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        cerr << "Usage: " << argv[0] << " <output_file> <checkpoint_file> [checkpoint_file ...]\n";
+        return 1;
+    }
+
+    auto start = high_resolution_clock::now();
+
+    checkpoint_t merged;
+    for (int i = 2; i < argc; i++) {
+        checkpoint_t ckpt;
+        if (ckpt_read(argv[i], &ckpt) < 0) {
+            cerr << "Error: could not read checkpoint file " << argv[i] << "!\n";
+            return 1;
+        }
+        if (i == 2) {
+            merged = ckpt;
+            continue;
+        }
+        if (ckpt.kind != merged.kind || ckpt.num_nodes != merged.num_nodes || ckpt.num_edges != merged.num_edges
+            || ckpt.fingerprint != merged.fingerprint || ckpt.values.size() != merged.values.size()) {
+            cerr << "Error: checkpoint " << argv[i] << " refers to a different computation!\n";
+            return 1;
+        }
+        // The accumulators of each checkpoint only include the contribution of its ranges.
+        for (const pair<int64_t, int64_t> &range : ckpt.done) {
+            if (ckpt_add_range(&merged, range.first, range.second) < 0) {
+                cerr << "Error: checkpoint " << argv[i] << " overlaps with the previous ones!\n";
+                return 1;
+            }
+        }
+        for (size_t j = 0; j < ckpt.values.size(); j++) merged.values[j] += ckpt.values[j];
+    }
+
+    if (ckpt_write(argv[1], &merged) < 0) {
+        cerr << "Error: could not write output file!\n";
+        return 1;
+    }
+
+    auto end = high_resolution_clock::now();
+    auto elapsed = duration_cast<nanoseconds>(end - start);
+
+    // Print information about the program execution.
+    cout << merged.num_nodes << '\t' << ckpt_num_done(&merged) << '\t' << elapsed.count() << '\n';
+    return 0;
+}
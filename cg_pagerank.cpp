@@ -15,6 +15,7 @@
  *
  *  INPUT:
  *  The weighted edge list for the collapsed graph.
+ *  Optionally, the binary node map of the graph (see nm_build.cpp).
  *
  *  OUTPUT:
  *  A TSV file summarizing the PageRank for each node.
@@ -34,6 +35,7 @@
 #include <chrono>
 #include <iostream>
 #include "graph.hpp"
+#include "nodemap.hpp"
 
 #define DAMPING_FACTOR 0.85 // default damping factor for PageRank
 
@@ -42,12 +44,16 @@ using namespace std::chrono;
 
 int main(int argc, char **argv) {
     if (argc < 3) {
-        cerr << "Usage: " << argv[0] << " <input_file> <output_file>\n";
+        cerr << "Usage: " << argv[0] << " <input_file> <output_file> [node_map_file]\n";
         return 1;
     }
     
     auto start = high_resolution_clock::now();
     
+    // Open the node map (if any), to write addresses instead of node identifiers.
+    node_map_t address_map;
+    node_map_t *map = nm_open_optional(argc, argv, 3, &address_map);
+
     // Load the graph from the corresponding file.
     FILE *input_file = fopen(argv[1], "r");
     if (!input_file) {
@@ -81,17 +87,18 @@ int main(int argc, char **argv) {
         cerr << "Error: could not open output file!\n";
         return 1;
     }
-    fprintf(output_file, "node_id\tpagerank\tpagerank_ntr\tpagerank_amount\n");
+    fprintf(output_file, "%s\tpagerank\tpagerank_ntr\tpagerank_amount\n", nm_column(map));
     for (int i = 0; i < num_nodes; i++) {
         double p = VECTOR(pagerank)[i];
         double p_ntr = VECTOR(pagerank_ntr)[i];
         double p_amount = VECTOR(pagerank_amount)[i];
-        fprintf(output_file, "%d\t%lf\t%lf\t%lf\n", i, p, p_ntr, p_amount); 
+        fprintf(output_file, "%d\t%lf\t%lf\t%lf\n", nm_label(map, i), p, p_ntr, p_amount); 
     }
     fclose(output_file);
 
     // Free the memory occupied by the graph.
     igraph_destroy(&graph);
+    if (map) nm_close(map);
     igraph_vector_destroy(&w_ntr);
     igraph_vector_destroy(&w_amount);
     igraph_vector_destroy(&pagerank);
@@ -0,0 +1,275 @@
+/**
+ * @file cg_triangles.cpp
+ * @author Matteo Loporchio
+ * @date 2025-05-19
+ *
+ *  This program reads the collapsed graph from a file and computes, for each node,
+ *  the number of triangles it belongs to, its local clustering coefficient and
+ *  information about reciprocated edges (i.e., pairs of edges u -> v and v -> u).
+ *
+ *  Triangles and clustering coefficients are computed on the undirected simple graph
+ *  obtained by ignoring edge directions. Edges are oriented from the endpoint with lower degree
+ *  to the endpoint with higher degree, so that each triangle is found exactly once by intersecting
+ *  the sorted (oriented) adjacency lists of the endpoints of an edge. Intersections use SSE2
+ *  instructions when available and nodes are processed in parallel with dynamic scheduling,
+ *  since the work associated with hubs is much larger than that of ordinary nodes.
+ *  The triangles found from a node are counted on its own (oriented) edges, without synchronization,
+ *  and the counts of the edges are then added to the other endpoints.
+ *
+ *  INPUT:
+ *  The weighted edge list for the collapsed graph.
+ *  Optionally, the binary node map of the graph (see nm_build.cpp).
+ *
+ *  OUTPUT:
+ *  A TSV file with one line for each node. Each line includes the following fields:
+ *      - numeric identifier of the node;
+ *      - number of triangles including the node;
+ *      - local clustering coefficient of the node (zero for nodes with less than two neighbors);
+ *      - number of reciprocated edges of the node;
+ *      - total number of transfers on the reciprocated outgoing edges of the node;
+ *      - total number of transfers on the reciprocated incoming edges of the node;
+ *      - total amount transferred on the reciprocated outgoing edges of the node;
+ *      - total amount transferred on the reciprocated incoming edges of the node.
+ *
+ *  PRINT:
+ *  The program prints the following information to stdout:
+ *      - number of graph nodes;
+ *      - number of graph edges;
+ *      - number of triangles;
+ *      - global transitivity (i.e., ratio between closed and connected triples);
+ *      - reciprocity (i.e., fraction of reciprocated edges);
+ *      - elapsed time (in nanoseconds).
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "graph.hpp"
+#include "nodemap.hpp"
+
+using namespace std;
+using namespace std::chrono;
+
+/**
+ * @brief Computes the intersection of two sorted lists of distinct identifiers.
+ *
+ * @param a first list
+ * @param na length of the first list
+ * @param b second list
+ * @param nb length of the second list
+ * @param out stores the positions in the first list of the common elements (must have room for min(na, nb) elements)
+ * @return the number of common elements
+ */
+static long intersect(const int *a, long na, const int *b, long nb, int *out) {
+    long i = 0, j = 0, k = 0;
+#ifdef __SSE2__
+    // Compare blocks of four elements against all rotations of the other block.
+    long na4 = na & ~3L, nb4 = nb & ~3L;
+    while (i < na4 && j < nb4) {
+        __m128i va = _mm_loadu_si128((const __m128i *) (a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i *) (b + j));
+        __m128i m0 = _mm_cmpeq_epi32(va, vb);
+        __m128i m1 = _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)));
+        __m128i m2 = _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2)));
+        __m128i m3 = _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3)));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_or_si128(_mm_or_si128(m0, m1), _mm_or_si128(m2, m3))));
+        while (mask) {
+            out[k++] = i + __builtin_ctz(mask);
+            mask &= mask - 1;
+        }
+        int a_max = a[i + 3], b_max = b[j + 3];
+        if (a_max <= b_max) i += 4;
+        if (b_max <= a_max) j += 4;
+    }
+#endif
+    // Merge the remaining elements.
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) i++;
+        else if (a[i] > b[j]) j++;
+        else {
+            out[k++] = i;
+            i++; j++;
+        }
+    }
+    return k;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        cerr << "Usage: " << argv[0] << " <input_file> <output_file> [node_map_file]\n";
+        return 1;
+    }
+
+    auto start = high_resolution_clock::now();
+
+    // Open the node map (if any), to write addresses instead of node identifiers.
+    node_map_t address_map;
+    node_map_t *map = nm_open_optional(argc, argv, 3, &address_map);
+
+    // Load the graph from the corresponding file.
+    FILE *input_file = fopen(argv[1], "r");
+    if (!input_file) {
+        cerr << "Error: could not open input file!\n";
+        return 1;
+    }
+    igraph_t graph;
+    igraph_vector_t w_ntr; // stores weights (total number of transfers)
+    igraph_vector_t w_amount; // stores weights (total value transferred)
+    igraph_vector_init(&w_ntr, 0);
+    igraph_vector_init(&w_amount, 0);
+    read_collapsed_graph(&graph, &w_ntr, &w_amount, input_file);
+    fclose(input_file);
+
+    // Obtain the number of nodes and edges.
+    igraph_integer_t num_nodes = igraph_vcount(&graph);
+    igraph_integer_t num_edges = igraph_ecount(&graph);
+
+    // Compute the reciprocated edges of each node.
+    // Every update only concerns the current node, hence no synchronization is needed.
+    csr_graph_t out;
+    build_csr(&graph, IGRAPH_OUT, &out);
+    vector<int> recip(num_nodes, 0);
+    vector<double> recip_out_ntr(num_nodes, 0), recip_in_ntr(num_nodes, 0);
+    vector<double> recip_out_amount(num_nodes, 0), recip_in_amount(num_nodes, 0);
+    long num_recip = 0;
+    #pragma omp parallel for schedule(dynamic, 256) reduction(+:num_recip)
+    for (int u = 0; u < num_nodes; u++) {
+        for (long i = out.offsets[u]; i < out.offsets[u + 1]; i++) {
+            int v = out.targets[i];
+            if (v == u) continue;
+            const int *first = out.targets.data() + out.offsets[v];
+            const int *last = out.targets.data() + out.offsets[v + 1];
+            const int *pos = lower_bound(first, last, u);
+            if (pos == last || *pos != u) continue;
+            int e = out.edge_ids[i];
+            int rev = out.edge_ids[pos - out.targets.data()];
+            recip[u]++;
+            recip_out_ntr[u] += VECTOR(w_ntr)[e];
+            recip_in_ntr[u] += VECTOR(w_ntr)[rev];
+            recip_out_amount[u] += VECTOR(w_amount)[e];
+            recip_in_amount[u] += VECTOR(w_amount)[rev];
+            num_recip++;
+        }
+    }
+    out = csr_graph_t();
+
+    // Build the undirected simple graph (without duplicate edges and self-loops).
+    csr_graph_t all;
+    build_csr(&graph, IGRAPH_ALL, &all);
+    vector<long> deg(num_nodes, 0);
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int u = 0; u < num_nodes; u++) {
+        long d = 0;
+        for (long i = all.offsets[u]; i < all.offsets[u + 1]; i++) {
+            int v = all.targets[i];
+            if (v != u && (i == all.offsets[u] || v != all.targets[i - 1])) d++;
+        }
+        deg[u] = d;
+    }
+
+    // Orient each edge from the endpoint with lower (degree, identifier) to the other one.
+    vector<long> fwd_offsets(num_nodes + 1, 0);
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int u = 0; u < num_nodes; u++) {
+        long d = 0;
+        for (long i = all.offsets[u]; i < all.offsets[u + 1]; i++) {
+            int v = all.targets[i];
+            if (v == u || (i > all.offsets[u] && v == all.targets[i - 1])) continue;
+            if (deg[u] < deg[v] || (deg[u] == deg[v] && u < v)) d++;
+        }
+        fwd_offsets[u + 1] = d;
+    }
+    for (int u = 0; u < num_nodes; u++) fwd_offsets[u + 1] += fwd_offsets[u];
+    vector<int> fwd(fwd_offsets[num_nodes]);
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int u = 0; u < num_nodes; u++) {
+        long k = fwd_offsets[u];
+        for (long i = all.offsets[u]; i < all.offsets[u + 1]; i++) {
+            int v = all.targets[i];
+            if (v == u || (i > all.offsets[u] && v == all.targets[i - 1])) continue;
+            if (deg[u] < deg[v] || (deg[u] == deg[v] && u < v)) fwd[k++] = v;
+        }
+    }
+    all = csr_graph_t();
+
+    // Count the triangles: each triangle (u, v, w) is found once from its lowest-ranked node u
+    // and counted on the edges (u, v) and (u, w), which are only updated by the thread processing u.
+    vector<long> triangles(num_nodes, 0);
+    vector<int> support(fwd.size(), 0); // number of triangles including each edge and found from its source
+    long num_triangles = 0;
+    #pragma omp parallel reduction(+:num_triangles)
+    {
+        vector<int> common;
+        #pragma omp for schedule(dynamic, 64)
+        for (int u = 0; u < num_nodes; u++) {
+            const int *nu = fwd.data() + fwd_offsets[u];
+            int *su = support.data() + fwd_offsets[u];
+            long du = fwd_offsets[u + 1] - fwd_offsets[u];
+            if (du < 2) continue;
+            if ((long) common.size() < du) common.resize(du);
+            long t_u = 0;
+            for (long i = 0; i < du; i++) {
+                int v = nu[i];
+                const int *nv = fwd.data() + fwd_offsets[v];
+                long dv = fwd_offsets[v + 1] - fwd_offsets[v];
+                long c = intersect(nu, du, nv, dv, &common[0]);
+                t_u += c;
+                su[i] += c;
+                for (long j = 0; j < c; j++) su[common[j]]++;
+            }
+            triangles[u] = t_u;
+            num_triangles += t_u;
+        }
+    }
+    // Add the triangles of each edge to its target (one update per edge instead of one per triangle).
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int u = 0; u < num_nodes; u++) {
+        for (long i = fwd_offsets[u]; i < fwd_offsets[u + 1]; i++) {
+            if (support[i] == 0) continue;
+            #pragma omp atomic
+            triangles[fwd[i]] += support[i];
+        }
+    }
+
+    // Compute the global transitivity.
+    double num_triples = 0;
+    for (int u = 0; u < num_nodes; u++) num_triples += 0.5 * deg[u] * (deg[u] - 1);
+    double transitivity = (num_triples > 0) ? (3.0 * num_triangles) / num_triples : 0;
+    double reciprocity = (num_edges > 0) ? ((double) num_recip) / num_edges : 0;
+
+    // Write the results to the output TSV file.
+    FILE *output_file = fopen(argv[2], "w");
+    if (!output_file) {
+        cerr << "Error: could not open output file!\n";
+        return 1;
+    }
+    fprintf(output_file, "%s\ttriangles\tclustering\trecip\trecip_out_ntr\trecip_in_ntr\trecip_out_amount\trecip_in_amount\n", nm_column(map));
+    for (int i = 0; i < num_nodes; i++) {
+        double clustering = (deg[i] > 1) ? (2.0 * triangles[i]) / (deg[i] * (deg[i] - 1.0)) : 0;
+        fprintf(output_file, "%d\t%ld\t%lf\t%d\t%lf\t%lf\t%lf\t%lf\n", nm_label(map, i), triangles[i], clustering,
+        recip[i], recip_out_ntr[i], recip_in_ntr[i], recip_out_amount[i], recip_in_amount[i]);
+    }
+    fclose(output_file);
+
+    // Free the memory occupied by the graph.
+    igraph_destroy(&graph);
+    if (map) nm_close(map);
+    igraph_vector_destroy(&w_ntr);
+    igraph_vector_destroy(&w_amount);
+
+    auto end = high_resolution_clock::now();
+    auto elapsed = duration_cast<nanoseconds>(end - start);
+
+    // Print information about the program execution.
+    cout << num_nodes << '\t'
+        << num_edges << '\t'
+        << num_triangles << '\t'
+        << transitivity << '\t'
+        << reciprocity << '\t'
+        << elapsed.count() << '\n';
+    return 0;
+}
@@ -0,0 +1,172 @@
+/**
+ * @file checkpoint.cpp
+ * @author Matteo Loporchio
+ * @date 2025-07-15
+ * 
+ *  This file contains the implementation of functions for saving and restoring the state of
+ *  long-running computations that iterate over the nodes of a graph.
+ *
+ *  The checkpoint file includes the following fields (in native byte order):
+ *      - magic number and type of computation;
+ *      - number of nodes, number of edges and fingerprint of the graph;
+ *      - number of processed ranges, followed by the ranges (pairs of 64-bit integers);
+ *      - number of accumulators, followed by the accumulators (64-bit floating point numbers).
+ */
+
+#include "checkpoint.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+
+/**
+ * @brief Computes the fingerprint of a graph from its adjacency lists.
+ * 
+ * @param csr the adjacency lists of the graph
+ * @return the fingerprint
+ */
+uint64_t graph_fingerprint(const csr_graph_t *csr) {
+    // FNV-1a hash of the adjacency lists.
+    uint64_t h = 0xcbf29ce484222325ULL;
+    auto mix = [&h](uint64_t x) {
+        h ^= x;
+        h *= 0x100000001b3ULL;
+    };
+    mix(csr->num_nodes);
+    for (long offset : csr->offsets) mix(offset);
+    for (int target : csr->targets) mix(target);
+    return h;
+}
+
+/**
+ * @brief Reads a checkpoint from a file.
+ * 
+ * @param path the path to the checkpoint file
+ * @param ckpt stores the checkpoint
+ * @return 0 on success, -1 if the file does not exist, -2 if the file is not a valid checkpoint
+ *  (or cannot be read)
+ */
+int ckpt_read(const char *path, checkpoint_t *ckpt) {
+    FILE *input_file = fopen(path, "rb");
+    if (!input_file) return (errno == ENOENT) ? -1 : -2;
+    uint64_t magic = 0;
+    int64_t num_ranges = -1, num_values = -1;
+    bool ok = fread(&magic, sizeof(magic), 1, input_file) == 1 && magic == CKPT_MAGIC
+        && fread(&ckpt->kind, sizeof(ckpt->kind), 1, input_file) == 1
+        && fread(&ckpt->num_nodes, sizeof(ckpt->num_nodes), 1, input_file) == 1
+        && fread(&ckpt->num_edges, sizeof(ckpt->num_edges), 1, input_file) == 1
+        && fread(&ckpt->fingerprint, sizeof(ckpt->fingerprint), 1, input_file) == 1
+        && ckpt->num_nodes >= 0 && fread(&num_ranges, sizeof(num_ranges), 1, input_file) == 1
+        && num_ranges >= 0 && num_ranges <= ckpt->num_nodes;
+    if (ok) {
+        ckpt->done.resize(num_ranges);
+        ok = fread(ckpt->done.data(), sizeof(ckpt->done[0]), num_ranges, input_file) == (size_t) num_ranges
+            && fread(&num_values, sizeof(num_values), 1, input_file) == 1
+            && num_values >= 0 && num_values <= std::max(ckpt->num_nodes, (int64_t) 2);
+        // Ranges must be sorted, disjoint and within the nodes of the graph.
+        for (int64_t i = 0; ok && i < num_ranges; i++) {
+            int64_t prev_end = (i > 0) ? ckpt->done[i - 1].second : 0;
+            ok = ckpt->done[i].first >= prev_end && ckpt->done[i].first < ckpt->done[i].second
+                && ckpt->done[i].second <= ckpt->num_nodes;
+        }
+    }
+    if (ok) {
+        ckpt->values.resize(num_values);
+        ok = fread(ckpt->values.data(), sizeof(double), num_values, input_file) == (size_t) num_values
+            && fgetc(input_file) == EOF;
+    }
+    fclose(input_file);
+    return ok ? 0 : -2;
+}
+
+/**
+ * @brief Writes a checkpoint to a file.
+ *  The checkpoint is first written to a temporary file, which then replaces the original one:
+ *  if the program is interrupted, the previous checkpoint is still valid.
+ * 
+ * @param path the path to the checkpoint file
+ * @param ckpt the checkpoint
+ * @return 0 on success, -1 if the file cannot be written
+ */
+int ckpt_write(const char *path, const checkpoint_t *ckpt) {
+    std::string tmp_path = std::string(path) + ".tmp";
+    FILE *output_file = fopen(tmp_path.c_str(), "wb");
+    if (!output_file) return -1;
+    uint64_t magic = CKPT_MAGIC;
+    int64_t num_ranges = ckpt->done.size(), num_values = ckpt->values.size();
+    bool ok = fwrite(&magic, sizeof(magic), 1, output_file) == 1
+        && fwrite(&ckpt->kind, sizeof(ckpt->kind), 1, output_file) == 1
+        && fwrite(&ckpt->num_nodes, sizeof(ckpt->num_nodes), 1, output_file) == 1
+        && fwrite(&ckpt->num_edges, sizeof(ckpt->num_edges), 1, output_file) == 1
+        && fwrite(&ckpt->fingerprint, sizeof(ckpt->fingerprint), 1, output_file) == 1
+        && fwrite(&num_ranges, sizeof(num_ranges), 1, output_file) == 1
+        && fwrite(ckpt->done.data(), sizeof(ckpt->done[0]), num_ranges, output_file) == (size_t) num_ranges
+        && fwrite(&num_values, sizeof(num_values), 1, output_file) == 1
+        && fwrite(ckpt->values.data(), sizeof(double), num_values, output_file) == (size_t) num_values;
+    // The content must be on disk before the file is renamed.
+    ok = ok && fflush(output_file) == 0 && fsync(fileno(output_file)) == 0;
+    if (fclose(output_file) != 0) ok = false;
+    if (!ok || rename(tmp_path.c_str(), path) != 0) {
+        remove(tmp_path.c_str());
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Marks a range of sources as processed.
+ * 
+ * @param ckpt the checkpoint
+ * @param begin first source of the range
+ * @param end last source of the range (excluded)
+ * @return 0 on success, -1 if the range overlaps with a range already processed
+ */
+int ckpt_add_range(checkpoint_t *ckpt, int64_t begin, int64_t end) {
+    if (begin >= end) return 0;
+    std::vector<std::pair<int64_t, int64_t>> &done = ckpt->done;
+    auto it = std::lower_bound(done.begin(), done.end(), std::make_pair(begin, end));
+    if (it != done.end() && it->first < end) return -1;
+    if (it != done.begin() && (it - 1)->second > begin) return -1;
+    it = done.insert(it, std::make_pair(begin, end));
+    // Merge the range with the adjacent ones.
+    if (it + 1 != done.end() && (it + 1)->first == it->second) {
+        it->second = (it + 1)->second;
+        done.erase(it + 1);
+    }
+    if (it != done.begin() && (it - 1)->second == it->first) {
+        (it - 1)->second = it->second;
+        done.erase(it);
+    }
+    return 0;
+}
+
+/**
+ * @brief Returns the sources of a range that have not been processed yet.
+ * 
+ * @param ckpt the checkpoint
+ * @param begin first source of the range
+ * @param end last source of the range (excluded)
+ * @return the list of ranges to be processed
+ */
+std::vector<std::pair<int64_t, int64_t>> ckpt_missing(const checkpoint_t *ckpt, int64_t begin, int64_t end) {
+    std::vector<std::pair<int64_t, int64_t>> missing;
+    int64_t pos = begin;
+    for (const std::pair<int64_t, int64_t> &r : ckpt->done) {
+        if (r.second <= pos) continue;
+        if (r.first >= end) break;
+        if (r.first > pos) missing.push_back(std::make_pair(pos, r.first));
+        pos = std::max(pos, r.second);
+    }
+    if (pos < end) missing.push_back(std::make_pair(pos, end));
+    return missing;
+}
+
+/**
+ * @brief Returns the number of sources processed.
+ */
+int64_t ckpt_num_done(const checkpoint_t *ckpt) {
+    int64_t count = 0;
+    for (const std::pair<int64_t, int64_t> &r : ckpt->done) count += r.second - r.first;
+    return count;
+}
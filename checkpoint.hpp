@@ -0,0 +1,91 @@
+/**
+ * @file checkpoint.hpp
+ * @author Matteo Loporchio
+ * @date 2025-07-15
+ * 
+ *  This file contains the definitions of functions for saving and restoring the state of
+ *  long-running computations that iterate over the nodes of a graph (e.g., one visit for each source).
+ *  A checkpoint stores the ranges of sources already processed and the partial accumulators,
+ *  together with a fingerprint of the graph, so that a computation can only be resumed on the same graph.
+ *  Checkpoints of disjoint source ranges (e.g., computed by independent processes) can be merged.
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "graph.hpp"
+
+#define CKPT_MAGIC 0x3154504b43544147ULL // "GATCKPT1" (in native byte order)
+#define CKPT_HARMONIC 1 // harmonic centrality: one accumulator for each node
+#define CKPT_DISTANCE 2 // average distance: sum of distances and number of reachable pairs
+
+/**
+ * @brief State of a computation.
+ */
+typedef struct {
+    int32_t kind; // type of computation
+    int64_t num_nodes;
+    int64_t num_edges;
+    uint64_t fingerprint; // fingerprint of the graph
+    std::vector<std::pair<int64_t, int64_t>> done; // processed source ranges [begin, end), sorted and disjoint
+    std::vector<double> values; // partial accumulators
+} checkpoint_t;
+
+/**
+ * @brief Computes the fingerprint of a graph from its adjacency lists.
+ * 
+ * @param csr the adjacency lists of the graph
+ * @return the fingerprint
+ */
+uint64_t graph_fingerprint(const csr_graph_t *csr);
+
+/**
+ * @brief Reads a checkpoint from a file.
+ * 
+ * @param path the path to the checkpoint file
+ * @param ckpt stores the checkpoint
+ * @return 0 on success, -1 if the file does not exist, -2 if the file is not a valid checkpoint
+ *  (or cannot be read)
+ */
+int ckpt_read(const char *path, checkpoint_t *ckpt);
+
+/**
+ * @brief Writes a checkpoint to a file.
+ *  The checkpoint is first written to a temporary file, which then replaces the original one:
+ *  if the program is interrupted, the previous checkpoint is still valid.
+ * 
+ * @param path the path to the checkpoint file
+ * @param ckpt the checkpoint
+ * @return 0 on success, -1 if the file cannot be written
+ */
+int ckpt_write(const char *path, const checkpoint_t *ckpt);
+
+/**
+ * @brief Marks a range of sources as processed.
+ * 
+ * @param ckpt the checkpoint
+ * @param begin first source of the range
+ * @param end last source of the range (excluded)
+ * @return 0 on success, -1 if the range overlaps with a range already processed
+ */
+int ckpt_add_range(checkpoint_t *ckpt, int64_t begin, int64_t end);
+
+/**
+ * @brief Returns the sources of a range that have not been processed yet.
+ * 
+ * @param ckpt the checkpoint
+ * @param begin first source of the range
+ * @param end last source of the range (excluded)
+ * @return the list of ranges to be processed
+ */
+std::vector<std::pair<int64_t, int64_t>> ckpt_missing(const checkpoint_t *ckpt, int64_t begin, int64_t end);
+
+/**
+ * @brief Returns the number of sources processed.
+ */
+int64_t ckpt_num_done(const checkpoint_t *ckpt);
+
+#endif
@@ -16,28 +16,57 @@
  *      - each node represents an address;
  *      - each edge (u, v) summarizes all transfers from address u to v.
  *      - each edge is labelled with the total number of transfers and the total amount of tokens exchanged.
+ *
+ *  Edge lists can also be compressed with gzip or zstd: in this case, they are decompressed
+ *  on the fly while the graph is being read.
  */
 
 #include "graph.hpp"
+#include "io.hpp"
 #include <algorithm>
 #include <cstdlib>
 #include <cstring>
 
+/**
+ * @brief Returns a stream with the decompressed content of an edge list file.
+ *  The program is terminated if the compression format is not supported.
+ */
+static FILE *open_edge_list(FILE *input_file) {
+    FILE *stream = open_decompressed(input_file);
+    if (!stream) {
+        fprintf(stderr, "Error: unsupported compression format!\n");
+        exit(1);
+    }
+    return stream;
+}
+
+/**
+ * @brief Checks that an edge list has been read completely.
+ *  The program is terminated if a read error occurred (e.g., a truncated compressed file).
+ */
+static void check_edge_list(FILE *stream) {
+    if (ferror(stream)) {
+        fprintf(stderr, "Error: could not read input file!\n");
+        exit(1);
+    }
+}
+
 /**
  * @brief Reads the multigraph edge list from a file and builds the corresponding graph.
  * 
  * @param graph stores the final graph
  * @param w_amount stores the final weight vector (with the amount of tokens transferred for each edge)
- * @param input_file text file containing the list of weighted edges
+ * @param input_file text file containing the list of weighted edges (possibly compressed)
  */
 void read_multigraph(igraph_t *graph, igraph_vector_t *weights, FILE *input_file) {
+    FILE *stream = open_edge_list(input_file);
     igraph_vector_int_t edges;
     igraph_vector_int_init(&edges, 0);
     //igraph_vector_int_reserve(&edges, 1000000*2);
     int max_node_id = 0;
     char *line_buf = NULL;
     size_t line_size = 0;
-    while (getline(&line_buf, &line_size, input_file) > 0) {
+    while (getline(&line_buf, &line_size, stream) > 0) {
         char *token = NULL;
         int token_count = 0;
         int from, to;
@@ -56,6 +85,8 @@ void read_multigraph(igraph_t *graph, igraph_vector_t *weights, FILE *input_file
         igraph_vector_push_back(weights, value);
         max_node_id = std::max({max_node_id, from, to});
     }
+    check_edge_list(stream);
+    if (stream != input_file) fclose(stream);
     int num_nodes = max_node_id + 1;
     igraph_empty(graph, num_nodes, IGRAPH_DIRECTED);
     igraph_add_edges(graph, &edges, NULL);
@@ -68,16 +99,17 @@ void read_multigraph(igraph_t *graph, igraph_vector_t *weights, FILE *input_file
  * @param graph stores the final graph
  * @param w_ntr stores the final weight vector (with total number of transfers for each edge)
  * @param w_amount stores the final weight vector (with total amount transferred for each edge)
- * @param input_file text file containing the list of weighted edges
+ * @param input_file text file containing the list of weighted edges (possibly compressed)
  */
 void read_collapsed_graph(igraph_t *graph, igraph_vector_t *w_ntr, igraph_vector_t *w_amount, FILE *input_file) {
+    FILE *stream = open_edge_list(input_file);
     igraph_vector_int_t edges;
     igraph_vector_int_init(&edges, 0);
     //igraph_vector_int_reserve(&edges, 1000000*2);
     int max_node_id = 0;
     char *line_buf = NULL;
     size_t line_size = 0;
-    while (getline(&line_buf, &line_size, input_file) > 0) {
+    while (getline(&line_buf, &line_size, stream) > 0) {
         char *token = NULL;
         int token_count = 0;
         int from, to, total_transfers;
@@ -99,6 +131,8 @@ void read_collapsed_graph(igraph_t *graph, igraph_vector_t *w_ntr, igraph_vector
         igraph_vector_push_back(w_amount, total_value);
         max_node_id = std::max({max_node_id, from, to});
     }
+    check_edge_list(stream);
+    if (stream != input_file) fclose(stream);
     int num_nodes = max_node_id + 1;
     igraph_empty(graph, num_nodes, IGRAPH_DIRECTED);
     igraph_add_edges(graph, &edges, NULL);
@@ -136,3 +170,59 @@ void get_largest_wcc(igraph_t *graph, igraph_t *comp) {
     igraph_vs_vector(&comp_vids, &comp_vertices);
     igraph_induced_subgraph(graph, comp, comp_vids, IGRAPH_SUBGRAPH_AUTO);
 }
+
+/**
+ * @brief Builds the adjacency lists of a graph in CSR format.
+ * @param graph the input graph
+ * @param mode type of neighbors to include (IGRAPH_OUT, IGRAPH_IN or IGRAPH_ALL)
+ * @param csr stores the adjacency lists
+ */
+void build_csr(const igraph_t *graph, igraph_neimode_t mode, csr_graph_t *csr) {
+    int num_nodes = igraph_vcount(graph);
+    long num_edges = igraph_ecount(graph);
+    igraph_vector_int_t edges;
+    igraph_vector_int_init(&edges, 0);
+    igraph_get_edgelist(graph, &edges, 0);
+    // Each edge (u, v) yields the entry v in the list of u (out-neighbors)
+    // and/or the entry u in the list of v (in-neighbors).
+    long num_entries = (mode == IGRAPH_ALL) ? 2 * num_edges : num_edges;
+    std::vector<int> src(num_entries), dst(num_entries), eid(num_entries);
+    long k = 0;
+    for (long e = 0; e < num_edges; e++) {
+        int from = VECTOR(edges)[2 * e];
+        int to = VECTOR(edges)[2 * e + 1];
+        if (mode & IGRAPH_OUT) {
+            src[k] = from; dst[k] = to; eid[k] = e; k++;
+        }
+        if (mode & IGRAPH_IN) {
+            src[k] = to; dst[k] = from; eid[k] = e; k++;
+        }
+    }
+    igraph_vector_int_destroy(&edges);
+    // Two stable counting sort passes (by neighbor, then by node) produce
+    // adjacency lists sorted by neighbor identifier.
+    std::vector<long> count(num_nodes + 1);
+    std::vector<int> tmp_src(num_entries), tmp_eid(num_entries);
+    std::vector<int> tmp_dst(num_entries);
+    for (long i = 0; i < num_entries; i++) count[dst[i] + 1]++;
+    for (int u = 0; u < num_nodes; u++) count[u + 1] += count[u];
+    for (long i = 0; i < num_entries; i++) {
+        long pos = count[dst[i]]++;
+        tmp_src[pos] = src[i]; tmp_dst[pos] = dst[i]; tmp_eid[pos] = eid[i];
+    }
+    std::vector<int>().swap(src);
+    std::vector<int>().swap(dst);
+    std::vector<int>().swap(eid);
+    csr->num_nodes = num_nodes;
+    csr->offsets.assign(num_nodes + 1, 0);
+    csr->targets.resize(num_entries);
+    csr->edge_ids.resize(num_entries);
+    for (long i = 0; i < num_entries; i++) csr->offsets[tmp_src[i] + 1]++;
+    for (int u = 0; u < num_nodes; u++) csr->offsets[u + 1] += csr->offsets[u];
+    std::vector<long> next(csr->offsets.begin(), csr->offsets.end() - 1);
+    for (long i = 0; i < num_entries; i++) {
+        long pos = next[tmp_src[i]]++;
+        csr->targets[pos] = tmp_dst[i];
+        csr->edge_ids[pos] = tmp_eid[i];
+    }
+}
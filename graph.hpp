@@ -22,8 +22,22 @@
 #define GRAPH_H
 
 #include <cstdio>
+#include <vector>
 #include <igraph.h>
 
+/**
+ * @brief Adjacency lists of a graph in compressed sparse row (CSR) format.
+ *  The neighbors of node u are targets[offsets[u]], ..., targets[offsets[u+1]-1], sorted by identifier.
+ *  For each neighbor, edge_ids stores the identifier of the corresponding igraph edge
+ *  (e.g., to access the weight vectors returned by the functions below).
+ */
+typedef struct {
+    int num_nodes;
+    std::vector<long> offsets;
+    std::vector<int> targets;
+    std::vector<int> edge_ids;
+} csr_graph_t;
+
 /**
  * @brief Reads the multigraph edge list from a file and builds the corresponding graph.
  * 
@@ -50,4 +64,12 @@ void read_collapsed_graph(igraph_t *graph, igraph_vector_t *w_ntr, igraph_vector
  */
 void get_largest_wcc(igraph_t *graph, igraph_t *comp);
 
+/**
+ * @brief Builds the adjacency lists of a graph in CSR format.
+ * @param graph the input graph
+ * @param mode type of neighbors to include (IGRAPH_OUT, IGRAPH_IN or IGRAPH_ALL)
+ * @param csr stores the adjacency lists
+ */
+void build_csr(const igraph_t *graph, igraph_neimode_t mode, csr_graph_t *csr);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,373 @@
+/**
+ * @file io.cpp
+ * @author Matteo Loporchio
+ * @date 2025-06-17
+ * 
+ *  This file contains the implementation of functions for reading large input files.
+ *  Files are memory-mapped, so that they can be parsed in parallel without copying
+ *  their content into user-space buffers.
+ *  Compressed files (gzip and, if compiled with GAT_ZSTD, zstd) can be read as streams,
+ *  with decompression running on a separate thread.
+ */
+
+#include "io.hpp"
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+#ifdef GAT_ZSTD
+#include <zstd.h>
+#endif
+
+#define RING_SIZE 8 // number of buffers between the decompression thread and the reader
+#define RING_BUFFER_SIZE (1 << 20) // size of each buffer (in bytes)
+#define INPUT_BUFFER_SIZE (1 << 20) // size of the buffer for compressed data (in bytes)
+#define MAGIC_SIZE 4 // number of bytes read to detect the format of a stream
+
+/**
+ * @brief State of a decompressed stream.
+ *  The decompression thread fills the buffers of the ring in order, while the reader consumes them:
+ *  a buffer is only accessed by the thread that owns it, hence the lock only protects the counters.
+ */
+typedef struct {
+    FILE *file; // original stream
+    stream_format_t format;
+    char prefix[MAGIC_SIZE]; // first bytes of the original stream (already consumed for detection)
+    size_t prefix_size, prefix_pos;
+    std::thread worker;
+    std::mutex lock;
+    std::condition_variable not_empty, not_full;
+    std::vector<char> buffers[RING_SIZE];
+    size_t sizes[RING_SIZE];
+    size_t head, count; // first full buffer and number of full buffers
+    size_t read_pos; // position of the reader in the head buffer
+    bool done, failed, closing;
+} decompressed_stream_t;
+
+/**
+ * @brief Waits for a free buffer of the ring.
+ * @return the buffer, or NULL if the stream is being closed
+ */
+static char *acquire_buffer(decompressed_stream_t *s) {
+    std::unique_lock<std::mutex> guard(s->lock);
+    s->not_full.wait(guard, [s] { return s->count < RING_SIZE || s->closing; });
+    if (s->closing) return NULL;
+    return s->buffers[(s->head + s->count) % RING_SIZE].data();
+}
+
+/**
+ * @brief Hands a full buffer of the ring to the reader.
+ */
+static void publish_buffer(decompressed_stream_t *s, size_t size) {
+    std::lock_guard<std::mutex> guard(s->lock);
+    s->sizes[(s->head + s->count) % RING_SIZE] = size;
+    s->count++;
+    s->not_empty.notify_one();
+}
+
+/**
+ * @brief Reads the next block of the original stream (starting with the bytes consumed for detection).
+ */
+static size_t read_compressed(decompressed_stream_t *s, char *buf, size_t size) {
+    size_t n = 0;
+    while (s->prefix_pos < s->prefix_size && n < size) buf[n++] = s->prefix[s->prefix_pos++];
+    return n + fread(buf + n, 1, size - n, s->file);
+}
+
+/**
+ * @brief Body of the reading thread for plain streams that cannot be rewound (e.g., pipes).
+ */
+static bool copy_plain(decompressed_stream_t *s) {
+    while (true) {
+        char *out = acquire_buffer(s);
+        if (!out) return true;
+        size_t n = read_compressed(s, out, RING_BUFFER_SIZE);
+        if (n > 0) publish_buffer(s, n);
+        if (n < RING_BUFFER_SIZE) return !ferror(s->file);
+    }
+}
+
+/**
+ * @brief Body of the decompression thread for gzip streams (possibly with multiple members).
+ */
+static bool inflate_gzip(decompressed_stream_t *s) {
+    std::vector<char> in(INPUT_BUFFER_SIZE);
+    z_stream z;
+    memset(&z, 0, sizeof(z));
+    if (inflateInit2(&z, 15 + 32) != Z_OK) return false;
+    bool ok = true;
+    bool in_member = false; // true if the current member has not been fully decompressed
+    char *out = NULL;
+    size_t out_size = 0;
+    while (ok) {
+        if (z.avail_in == 0) {
+            z.avail_in = read_compressed(s, in.data(), in.size());
+            z.next_in = (Bytef *) in.data();
+            if (z.avail_in == 0) break;
+        }
+        if (!out) {
+            out = acquire_buffer(s);
+            if (!out) break;
+            out_size = 0;
+        }
+        z.next_out = (Bytef *) out + out_size;
+        z.avail_out = RING_BUFFER_SIZE - out_size;
+        int ret = inflate(&z, Z_NO_FLUSH);
+        out_size = RING_BUFFER_SIZE - z.avail_out;
+        if (ret == Z_STREAM_END) {
+            // Further input (if any) belongs to the next member.
+            inflateReset(&z);
+            in_member = false;
+        }
+        else if (ret == Z_OK || ret == Z_BUF_ERROR) in_member = true;
+        else ok = false;
+        if (out_size == RING_BUFFER_SIZE) {
+            publish_buffer(s, out_size);
+            out = NULL;
+        }
+    }
+    if (out && out_size > 0) publish_buffer(s, out_size);
+    inflateEnd(&z);
+    // A stream ending in the middle of a member is truncated.
+    return ok && !in_member && !ferror(s->file);
+}
+
+#ifdef GAT_ZSTD
+/**
+ * @brief Body of the decompression thread for zstd streams (possibly with multiple frames).
+ */
+static bool inflate_zstd(decompressed_stream_t *s) {
+    std::vector<char> in(INPUT_BUFFER_SIZE);
+    ZSTD_DStream *z = ZSTD_createDStream();
+    if (!z) return false;
+    ZSTD_initDStream(z);
+    ZSTD_inBuffer input = {in.data(), 0, 0};
+    size_t ret = 0; // 0 if the last frame has been fully decompressed
+    bool ok = true;
+    char *out = NULL;
+    size_t out_size = 0;
+    while (ok) {
+        if (input.pos == input.size) {
+            input.size = read_compressed(s, in.data(), in.size());
+            input.pos = 0;
+            if (input.size == 0) break;
+        }
+        if (!out) {
+            out = acquire_buffer(s);
+            if (!out) break;
+            out_size = 0;
+        }
+        ZSTD_outBuffer output = {out, RING_BUFFER_SIZE, out_size};
+        ret = ZSTD_decompressStream(z, &output, &input);
+        if (ZSTD_isError(ret)) ok = false;
+        out_size = output.pos;
+        if (out_size == RING_BUFFER_SIZE) {
+            publish_buffer(s, out_size);
+            out = NULL;
+        }
+    }
+    if (out && out_size > 0) publish_buffer(s, out_size);
+    ZSTD_freeDStream(z);
+    // A stream ending in the middle of a frame is truncated.
+    return ok && ret == 0 && !ferror(s->file);
+}
+#endif
+
+/**
+ * @brief Body of the decompression thread.
+ */
+static void decompress(decompressed_stream_t *s) {
+    bool ok;
+    if (s->format == FORMAT_GZIP) ok = inflate_gzip(s);
+#ifdef GAT_ZSTD
+    else if (s->format == FORMAT_ZSTD) ok = inflate_zstd(s);
+#endif
+    else ok = copy_plain(s);
+    std::lock_guard<std::mutex> guard(s->lock);
+    s->failed = !ok;
+    s->done = true;
+    s->not_empty.notify_one();
+}
+
+/**
+ * @brief Read function of the decompressed stream (see fopencookie).
+ */
+static ssize_t stream_read(void *cookie, char *buf, size_t size) {
+    decompressed_stream_t *s = (decompressed_stream_t *) cookie;
+    size_t copied = 0;
+    while (copied < size) {
+        {
+            std::unique_lock<std::mutex> guard(s->lock);
+            s->not_empty.wait(guard, [s] { return s->count > 0 || s->done; });
+            if (s->count == 0) {
+                if (s->failed && copied == 0) return -1;
+                break;
+            }
+        }
+        size_t avail = s->sizes[s->head] - s->read_pos;
+        size_t n = (size - copied < avail) ? size - copied : avail;
+        memcpy(buf + copied, s->buffers[s->head].data() + s->read_pos, n);
+        copied += n;
+        s->read_pos += n;
+        if (s->read_pos == s->sizes[s->head]) {
+            std::lock_guard<std::mutex> guard(s->lock);
+            s->head = (s->head + 1) % RING_SIZE;
+            s->count--;
+            s->read_pos = 0;
+            s->not_full.notify_one();
+        }
+    }
+    return copied;
+}
+
+/**
+ * @brief Close function of the decompressed stream (see fopencookie).
+ */
+static int stream_close(void *cookie) {
+    decompressed_stream_t *s = (decompressed_stream_t *) cookie;
+    {
+        std::lock_guard<std::mutex> guard(s->lock);
+        s->closing = true;
+        s->not_full.notify_one();
+    }
+    s->worker.join();
+    delete s;
+    return 0;
+}
+
+/**
+ * @brief Maps a file into memory (read-only).
+ * 
+ * @param path the path to the file
+ * @param file stores the mapped file
+ * @return 0 on success, -1 if the file cannot be opened or mapped (e.g., it is not a regular file)
+ */
+int map_file(const char *path, mapped_file_t *file) {
+    file->data = NULL;
+    file->size = 0;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    struct stat st;
+    // Pipes and other special files report no size and cannot be mapped: they must be read as streams.
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return -1;
+    }
+    // An empty file cannot be mapped, but it is still a valid input.
+    if (st.st_size > 0) {
+        void *addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            close(fd);
+            return -1;
+        }
+        // Files are scanned from beginning to end: ask the kernel for aggressive read-ahead.
+        madvise(addr, st.st_size, MADV_SEQUENTIAL);
+        file->data = (const char *) addr;
+        file->size = st.st_size;
+    }
+    close(fd);
+    return 0;
+}
+
+/**
+ * @brief Releases a memory-mapped file.
+ * 
+ * @param file the mapped file
+ */
+void unmap_file(mapped_file_t *file) {
+    if (file->data) munmap((void *) file->data, file->size);
+    file->data = NULL;
+    file->size = 0;
+}
+
+/**
+ * @brief Splits a memory-mapped file into blocks of (approximately) equal size.
+ *  Each block ends with a newline character (except possibly the last one),
+ *  so that no line is split between two blocks.
+ * 
+ * @param data the content of the file
+ * @param size the size of the file
+ * @param block_size the target size of each block
+ * @param bounds stores the offsets of the blocks (block i is [bounds[i], bounds[i+1]))
+ * @param max_blocks the maximum number of blocks (bounds must have room for max_blocks + 1 offsets)
+ * @return the number of blocks
+ */
+size_t split_lines(const char *data, size_t size, size_t block_size, size_t *bounds, size_t max_blocks) {
+    size_t num_blocks = 0;
+    size_t pos = 0;
+    bounds[0] = 0;
+    while (pos < size && num_blocks < max_blocks) {
+        size_t end = size;
+        if (size - pos > block_size) {
+            const char *nl = (const char *) memchr(data + pos + block_size, '\n', size - pos - block_size);
+            if (nl) end = (nl - data) + 1;
+        }
+        bounds[++num_blocks] = end;
+        pos = end;
+    }
+    return num_blocks;
+}
+
+/**
+ * @brief Detects the compression format of a file from the magic number at its beginning.
+ * 
+ * @param data the first bytes of the file
+ * @param size the number of bytes available
+ * @return the format of the file
+ */
+stream_format_t detect_format(const char *data, size_t size) {
+    static const unsigned char gzip_magic[] = {0x1f, 0x8b};
+    static const unsigned char zstd_magic[] = {0x28, 0xb5, 0x2f, 0xfd};
+    if (size >= sizeof(gzip_magic) && !memcmp(data, gzip_magic, sizeof(gzip_magic))) return FORMAT_GZIP;
+    if (size >= sizeof(zstd_magic) && !memcmp(data, zstd_magic, sizeof(zstd_magic))) return FORMAT_ZSTD;
+    return FORMAT_PLAIN;
+}
+
+/**
+ * @brief Returns a stream with the decompressed content of a file.
+ *  The format is detected from the magic number at the beginning of the file: if the file is not
+ *  compressed, the original stream is returned (unless it cannot be rewound, e.g., a pipe). Otherwise, the returned stream is fed by a thread
+ *  that decompresses the file into a bounded ring of buffers, so that decompression overlaps
+ *  with the processing of the stream. Closing the returned stream does not close the original one.
+ *  If the file is truncated or corrupted, reading the returned stream fails (see ferror).
+ * 
+ * @param file the original stream
+ * @return the decompressed stream, or NULL if the compression format is not supported
+ */
+FILE *open_decompressed(FILE *file) {
+    long pos = ftell(file);
+    char prefix[MAGIC_SIZE];
+    size_t prefix_size = fread(prefix, 1, MAGIC_SIZE, file);
+    stream_format_t format = detect_format(prefix, prefix_size);
+#ifndef GAT_ZSTD
+    if (format == FORMAT_ZSTD) return NULL;
+#endif
+    // Plain files are rewound to the beginning and read directly.
+    if (format == FORMAT_PLAIN && pos >= 0 && fseek(file, pos, SEEK_SET) == 0) return file;
+    decompressed_stream_t *s = new decompressed_stream_t();
+    s->file = file;
+    s->format = format;
+    memcpy(s->prefix, prefix, prefix_size);
+    s->prefix_size = prefix_size;
+    s->prefix_pos = 0;
+    for (int i = 0; i < RING_SIZE; i++) s->buffers[i].resize(RING_BUFFER_SIZE);
+    s->head = s->count = s->read_pos = 0;
+    s->done = s->failed = s->closing = false;
+    cookie_io_functions_t functions;
+    memset(&functions, 0, sizeof(functions));
+    functions.read = stream_read;
+    functions.close = stream_close;
+    s->worker = std::thread(decompress, s);
+    FILE *stream = fopencookie(s, "r", functions);
+    if (!stream) {
+        stream_close(s);
+        return NULL;
+    }
+    return stream;
+}
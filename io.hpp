@@ -0,0 +1,84 @@
+/**
+ * @file io.hpp
+ * @author Matteo Loporchio
+ * @date 2025-06-17
+ * 
+ *  This file contains the definitions of functions for reading large input files.
+ *  Files are memory-mapped, so that they can be parsed in parallel without copying
+ *  their content into user-space buffers.
+ *  Compressed files (gzip and, if compiled with GAT_ZSTD, zstd) can be read as streams,
+ *  with decompression running on a separate thread.
+ */
+
+#ifndef IO_H
+#define IO_H
+
+#include <cstddef>
+#include <cstdio>
+
+/**
+ * @brief Format of a file (or stream).
+ */
+typedef enum { FORMAT_PLAIN, FORMAT_GZIP, FORMAT_ZSTD } stream_format_t;
+
+/**
+ * @brief A read-only memory-mapped file.
+ */
+typedef struct {
+    const char *data;
+    size_t size;
+} mapped_file_t;
+
+/**
+ * @brief Maps a file into memory (read-only).
+ * 
+ * @param path the path to the file
+ * @param file stores the mapped file
+ * @return 0 on success, -1 if the file cannot be opened or mapped (e.g., it is not a regular file)
+ */
+int map_file(const char *path, mapped_file_t *file);
+
+/**
+ * @brief Releases a memory-mapped file.
+ * 
+ * @param file the mapped file
+ */
+void unmap_file(mapped_file_t *file);
+
+/**
+ * @brief Splits a memory-mapped file into blocks of (approximately) equal size.
+ *  Each block ends with a newline character (except possibly the last one),
+ *  so that no line is split between two blocks.
+ * 
+ * @param data the content of the file
+ * @param size the size of the file
+ * @param block_size the target size of each block
+ * @param bounds stores the offsets of the blocks (block i is [bounds[i], bounds[i+1]))
+ * @param max_blocks the maximum number of blocks (bounds must have room for max_blocks + 1 offsets)
+ * @return the number of blocks
+ */
+size_t split_lines(const char *data, size_t size, size_t block_size, size_t *bounds, size_t max_blocks);
+
+/**
+ * @brief Detects the compression format of a file from the magic number at its beginning.
+ * 
+ * @param data the first bytes of the file
+ * @param size the number of bytes available
+ * @return the format of the file
+ */
+stream_format_t detect_format(const char *data, size_t size);
+
+/**
+ * @brief Returns a stream with the decompressed content of a file.
+ *  The format is detected from the magic number at the beginning of the file: if the file is not
+ *  compressed, the original stream is returned (unless it cannot be rewound, e.g., a pipe). Otherwise, the returned stream is fed by a thread
+ *  that decompresses the file into a bounded ring of buffers, so that decompression overlaps
+ *  with the processing of the stream. Closing the returned stream does not close the original one.
+ *  If the file is truncated or corrupted, reading the returned stream fails (see ferror).
+ * 
+ * @param file the original stream
+ * @return the decompressed stream, or NULL if the compression format is not supported
+ */
+FILE *open_decompressed(FILE *file);
+
+#endif
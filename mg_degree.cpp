@@ -9,6 +9,7 @@
  *
  *  INPUT:
  *  The weighted edge list for the multigraph.
+ *  Optionally, the binary node map of the graph (see nm_build.cpp).
  *
  *  OUTPUT:
  *  A TSV file summarizing degree and strength properties for each node.
@@ -30,18 +31,23 @@
 #include <chrono>
 #include <iostream>
 #include "graph.hpp"
+#include "nodemap.hpp"
 
 using namespace std;
 using namespace std::chrono;
 
 int main(int argc, char **argv) {
     if (argc < 3) {
-        cerr << "Usage: " << argv[0] << " <input_file> <output_file>\n";
+        cerr << "Usage: " << argv[0] << " <input_file> <output_file> [node_map_file]\n";
         return 1;
     }
     
     auto start = high_resolution_clock::now();
     
+    // Open the node map (if any), to write addresses instead of node identifiers.
+    node_map_t address_map;
+    node_map_t *map = nm_open_optional(argc, argv, 3, &address_map);
+
     // Load the graph from the corresponding file.
     FILE *input_file = fopen(argv[1], "r");
     if (!input_file) {
@@ -76,18 +82,19 @@ int main(int argc, char **argv) {
         cerr << "Error: could not open output file!\n";
         return 1;
     }
-    fprintf(output_file, "node_id\tin_degree\tout_degree\tin_strength\tout_strength\n");
+    fprintf(output_file, "%s\tin_degree\tout_degree\tin_strength\tout_strength\n", nm_column(map));
     for (int i = 0; i < num_nodes; i++) {
         int indeg = VECTOR(indeg_v)[i];
         int outdeg = VECTOR(outdeg_v)[i];
         double instr = VECTOR(instr_v)[i];
         double outstr = VECTOR(outstr_v)[i];
-        fprintf(output_file, "%d\t%d\t%d\t%lf\t%lf\n", i, indeg, outdeg, instr, outstr);
+        fprintf(output_file, "%d\t%d\t%d\t%lf\t%lf\n", nm_label(map, i), indeg, outdeg, instr, outstr);
     }
     fclose(output_file);
 
     // Free the memory occupied by the graph.
     igraph_destroy(&graph);
+    if (map) nm_close(map);
     igraph_vector_destroy(&weights);
     igraph_vector_int_destroy(&indeg_v);
     igraph_vector_int_destroy(&outdeg_v);
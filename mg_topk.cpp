@@ -0,0 +1,441 @@
+/**
+ * @file mg_topk.cpp
+ * @author Matteo Loporchio
+ * @date 2025-07-01
+ *
+ *  This program reads the multigraph edge list and finds the top-k nodes by out-strength
+ *  and in-strength, as well as the top-k pairs of nodes by total amount and number of transfers,
+ *  without building the graph. The computation uses a fixed amount of memory, regardless of
+ *  the number of nodes and edges.
+ *
+ *  For each of the four quantities, the edges are summarized with two sketches:
+ *      - a Space-Saving summary with a fixed number of counters, which keeps the candidate keys
+ *        together with an overestimate of their value and the maximum error of the estimate;
+ *      - a Count-Min sketch, which provides another overestimate of the value of any key.
+ *  The input file is memory-mapped and split into blocks that are parsed in parallel:
+ *  each thread owns its sketches, which are merged at the end. For a key missing from
+ *  the summary of a thread, the value is at most the smallest counter of the summary.
+ *  The upper bound of each key is the smallest of the two merged overestimates, so the gap between
+ *  the lower and upper bound is at most W / counters, where W is the total weight of the edges.
+ *  Compressed edge lists and pipes are read as streams (with decompression on the fly) and parsed in batches.
+ *
+ *  INPUT:
+ *  The program requires the following arguments:
+ *      1. The path to the weighted edge list for the multigraph.
+ *      2. The base name for the output files.
+ *      3. The number k of results for each quantity.
+ *      4. (Optional) The number of counters of each Space-Saving summary (default: 65536).
+ *      5. (Optional) The width of each Count-Min sketch (default: 65536).
+ *      6. (Optional) The depth of each Count-Min sketch (default: 4).
+ *      7. (Optional) The path to the binary node map of the graph (see nm_build.cpp).
+ *
+ *  OUTPUT:
+ *  The program creates the following TSV files, sorted by decreasing upper bound:
+ *      - <base>_out_str.tsv: top-k nodes by out-strength (amount sent);
+ *      - <base>_in_str.tsv: top-k nodes by in-strength (amount received);
+ *      - <base>_pair_amount.tsv: top-k pairs by total amount transferred;
+ *      - <base>_pair_ntr.tsv: top-k pairs by number of transfers.
+ *  Each line of the node files includes the numeric identifier of the node, while each line of
+ *  the pair files includes the numeric identifiers of the sender and the recipient
+ *  (or their addresses, if a node map is given).
+ *  Both are followed by a lower bound and an upper bound to the value of the node (or pair).
+ *
+ *  PRINT:
+ *  The program prints the following information to stdout:
+ *      - number of edges read;
+ *      - elapsed time (in nanoseconds).
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <omp.h>
+#include "io.hpp"
+#include "nodemap.hpp"
+
+#define BLOCK_SIZE (16 << 20) // target size of each block of the input file (in bytes)
+#define STREAM_BATCH_SIZE (256 << 20) // size of the buffer for compressed input, shared by all threads (in bytes)
+#define BLOCKS_PER_THREAD 4 // number of blocks processed by each thread in a batch
+#define DEFAULT_COUNTERS 65536 // default number of counters of each Space-Saving summary
+#define DEFAULT_CM_WIDTH 65536 // default width of each Count-Min sketch
+#define DEFAULT_CM_DEPTH 4 // default depth of each Count-Min sketch
+#define NUM_METRICS 4 // out-strength, in-strength, pair amount, pair count
+
+using namespace std;
+using namespace std::chrono;
+
+/**
+ * @brief A counter of the Space-Saving summary.
+ *  The value of the key is at least count - error and at most count.
+ */
+typedef struct {
+    uint64_t key;
+    double count;
+    double error;
+} counter_t;
+
+/**
+ * @brief Space-Saving summary with weighted updates.
+ *  Counters are stored in a min-heap (by count) indexed by key.
+ */
+typedef struct {
+    size_t capacity;
+    vector<counter_t> heap;
+    unordered_map<uint64_t, size_t> pos; // position of each key in the heap
+} space_saving_t;
+
+/**
+ * @brief Count-Min sketch: the value of a key is at most the minimum of its cells.
+ */
+typedef struct {
+    size_t width;
+    int depth;
+    vector<double> table;
+} count_min_t;
+
+/**
+ * @brief Sketches owned by a thread (one pair for each quantity).
+ */
+typedef struct {
+    space_saving_t ss[NUM_METRICS];
+    count_min_t cm[NUM_METRICS];
+    long num_edges;
+} sketch_set_t;
+
+/**
+ * @brief A result, i.e., a key with the bounds to its value.
+ */
+typedef struct {
+    uint64_t key;
+    double lower;
+    double upper;
+} result_t;
+
+static void ss_init(space_saving_t &s, size_t capacity) {
+    s.capacity = capacity;
+    s.heap.reserve(capacity);
+    s.pos.reserve(2 * capacity);
+}
+
+static inline void ss_swap(space_saving_t &s, size_t i, size_t j) {
+    swap(s.heap[i], s.heap[j]);
+    s.pos[s.heap[i].key] = i;
+    s.pos[s.heap[j].key] = j;
+}
+
+static void ss_sift_up(space_saving_t &s, size_t i) {
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (s.heap[parent].count <= s.heap[i].count) break;
+        ss_swap(s, i, parent);
+        i = parent;
+    }
+}
+
+static void ss_sift_down(space_saving_t &s, size_t i) {
+    size_t n = s.heap.size();
+    while (true) {
+        size_t l = 2 * i + 1, r = l + 1, min_pos = i;
+        if (l < n && s.heap[l].count < s.heap[min_pos].count) min_pos = l;
+        if (r < n && s.heap[r].count < s.heap[min_pos].count) min_pos = r;
+        if (min_pos == i) break;
+        ss_swap(s, i, min_pos);
+        i = min_pos;
+    }
+}
+
+/**
+ * @brief Adds a weight to the value of a key.
+ *  If the key is not monitored and the summary is full, it replaces the key with the smallest count.
+ */
+static void ss_update(space_saving_t &s, uint64_t key, double weight) {
+    auto it = s.pos.find(key);
+    if (it != s.pos.end()) {
+        size_t i = it->second;
+        s.heap[i].count += weight;
+        ss_sift_down(s, i);
+        return;
+    }
+    if (s.heap.size() < s.capacity) {
+        counter_t c = {key, weight, 0};
+        s.heap.push_back(c);
+        s.pos[key] = s.heap.size() - 1;
+        ss_sift_up(s, s.heap.size() - 1);
+        return;
+    }
+    counter_t &c = s.heap[0];
+    s.pos.erase(c.key);
+    c.key = key;
+    c.error = c.count;
+    c.count += weight;
+    s.pos[key] = 0;
+    ss_sift_down(s, 0);
+}
+
+/**
+ * @brief Returns the largest possible value of a key not monitored by the summary.
+ */
+static inline double ss_missing(const space_saving_t &s) {
+    return (s.heap.size() < s.capacity) ? 0 : s.heap[0].count;
+}
+
+static void cm_init(count_min_t &c, size_t width, int depth) {
+    c.width = width;
+    c.depth = depth;
+    c.table.assign(width * depth, 0);
+}
+
+/**
+ * @brief Returns the cell of a key in a given row (the same for all threads).
+ */
+static inline size_t cm_cell(const count_min_t &c, uint64_t key, int row) {
+    // SplitMix64 finalizer, with a different seed for each row.
+    uint64_t z = key + 0x9e3779b97f4a7c15ULL * (row + 1);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z ^= z >> 31;
+    return row * c.width + (z % c.width);
+}
+
+static inline void cm_update(count_min_t &c, uint64_t key, double weight) {
+    for (int r = 0; r < c.depth; r++) c.table[cm_cell(c, key, r)] += weight;
+}
+
+static double cm_estimate(const count_min_t &c, uint64_t key) {
+    double value = c.table[cm_cell(c, key, 0)];
+    for (int r = 1; r < c.depth; r++) value = min(value, c.table[cm_cell(c, key, r)]);
+    return value;
+}
+
+/**
+ * @brief Parses a block of the edge list and updates the sketches of a thread.
+ */
+static void parse_block(const char *p, const char *end, sketch_set_t &s) {
+    while (p < end) {
+        const char *nl = (const char *) memchr(p, '\n', end - p);
+        if (!nl) nl = end;
+        char *q;
+        long from = strtol(p, &q, 10);
+        if (q < nl && *q == '\t') {
+            long to = strtol(q + 1, &q, 10);
+            if (q < nl && *q == '\t') {
+                double amount = strtod(q + 1, NULL);
+                uint64_t pair = (((uint64_t) (uint32_t) from) << 32) | (uint32_t) to;
+                ss_update(s.ss[0], from, amount);
+                cm_update(s.cm[0], from, amount);
+                ss_update(s.ss[1], to, amount);
+                cm_update(s.cm[1], to, amount);
+                ss_update(s.ss[2], pair, amount);
+                cm_update(s.cm[2], pair, amount);
+                ss_update(s.ss[3], pair, 1);
+                cm_update(s.cm[3], pair, 1);
+                s.num_edges++;
+            }
+        }
+        p = nl + 1;
+    }
+}
+
+/**
+ * @brief Splits a sequence of complete lines into blocks and parses them in parallel.
+ */
+static void parse_lines(const char *data, size_t size, size_t block_size, vector<sketch_set_t> &sketches) {
+    size_t max_blocks = BLOCKS_PER_THREAD * sketches.size();
+    vector<size_t> bounds(max_blocks + 1);
+    size_t pos = 0;
+    while (pos < size) {
+        size_t num_blocks = split_lines(data + pos, size - pos, block_size, &bounds[0], max_blocks);
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (size_t b = 0; b < num_blocks; b++)
+            parse_block(data + pos + bounds[b], data + pos + bounds[b + 1], sketches[omp_get_thread_num()]);
+        pos += bounds[num_blocks];
+    }
+}
+
+/**
+ * @brief Reads a compressed (or piped) edge list in batches of complete lines.
+ *  The size of each batch is fixed and split among the threads.
+ * @return 0 on success, -1 if the compression format is not supported, -2 if the input cannot be read
+ */
+static int parse_stream(FILE *input_file, vector<sketch_set_t> &sketches) {
+    FILE *stream = open_decompressed(input_file);
+    if (!stream) return -1;
+    size_t capacity = STREAM_BATCH_SIZE;
+    size_t block_size = max((size_t) 1, capacity / (BLOCKS_PER_THREAD * sketches.size()));
+    unique_ptr<char[]> buf(new char[capacity]);
+    size_t filled = 0;
+    int status = 0;
+    while (true) {
+        size_t n = fread(buf.get() + filled, 1, capacity - filled, stream);
+        filled += n;
+        if (n == 0) {
+            if (ferror(stream)) status = -2;
+            else parse_lines(buf.get(), filled, block_size, sketches);
+            break;
+        }
+        // Parse all complete lines and keep the last (partial) one for the next batch.
+        size_t last = filled;
+        while (last > 0 && buf[last - 1] != '\n') last--;
+        if (last == 0) {
+            // A single line longer than the buffer (only for malformed inputs).
+            if (filled == capacity) {
+                char *larger = new char[2 * capacity];
+                memcpy(larger, buf.get(), filled);
+                buf.reset(larger);
+                capacity *= 2;
+            }
+            continue;
+        }
+        parse_lines(buf.get(), last, block_size, sketches);
+        memmove(buf.get(), buf.get() + last, filled - last);
+        filled -= last;
+    }
+    if (stream != input_file) fclose(stream);
+    return status;
+}
+
+/**
+ * @brief Merges the sketches of all threads for a quantity and returns the k keys
+ *  with the largest upper bounds.
+ */
+static vector<result_t> merge_top(vector<sketch_set_t> &sketches, int metric, size_t k) {
+    // Sum the Count-Min sketches (they are linear).
+    count_min_t &cm = sketches[0].cm[metric];
+    for (size_t t = 1; t < sketches.size(); t++) {
+        const vector<double> &table = sketches[t].cm[metric].table;
+        for (size_t i = 0; i < table.size(); i++) cm.table[i] += table[i];
+        vector<double>().swap(sketches[t].cm[metric].table);
+    }
+    // Every key monitored by at least one summary is a candidate.
+    unordered_map<uint64_t, size_t> index;
+    vector<result_t> results;
+    for (size_t t = 0; t < sketches.size(); t++) {
+        for (const counter_t &c : sketches[t].ss[metric].heap) {
+            if (index.count(c.key)) continue;
+            index[c.key] = results.size();
+            result_t r = {c.key, 0, 0};
+            results.push_back(r);
+        }
+    }
+    for (size_t t = 0; t < sketches.size(); t++) {
+        const space_saving_t &s = sketches[t].ss[metric];
+        double missing = ss_missing(s);
+        for (result_t &r : results) {
+            auto it = s.pos.find(r.key);
+            if (it == s.pos.end()) r.upper += missing;
+            else {
+                const counter_t &c = s.heap[it->second];
+                r.lower += c.count - c.error;
+                r.upper += c.count;
+            }
+        }
+    }
+    for (result_t &r : results) r.upper = max(r.lower, min(r.upper, cm_estimate(cm, r.key)));
+    size_t num_results = min(k, results.size());
+    partial_sort(results.begin(), results.begin() + num_results, results.end(),
+        [](const result_t &a, const result_t &b) { return a.upper > b.upper; });
+    results.resize(num_results);
+    return results;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 4) {
+        cerr << "Usage: " << argv[0] << " <input_file> <output_base> <k> [counters] [cm_width] [cm_depth] [node_map_file]\n";
+        return 1;
+    }
+    long k = atol(argv[3]);
+    long counters = (argc > 4) ? atol(argv[4]) : DEFAULT_COUNTERS;
+    long cm_width = (argc > 5) ? atol(argv[5]) : DEFAULT_CM_WIDTH;
+    int cm_depth = (argc > 6) ? atoi(argv[6]) : DEFAULT_CM_DEPTH;
+    if (k <= 0 || counters < k) {
+        cerr << "Error: k must be positive and at most equal to the number of counters!\n";
+        return 1;
+    }
+    if (cm_width <= 0 || cm_depth <= 0) {
+        cerr << "Error: the width and depth of the Count-Min sketch must be positive!\n";
+        return 1;
+    }
+
+    auto start = high_resolution_clock::now();
+
+    // Open the node map (if any), to write addresses instead of node identifiers.
+    node_map_t address_map;
+    node_map_t *map = nm_open_optional(argc, argv, 7, &address_map);
+
+    // Initialize the sketches of each thread.
+    int num_threads = omp_get_max_threads();
+    vector<sketch_set_t> sketches(num_threads);
+    #pragma omp parallel for
+    for (int t = 0; t < num_threads; t++) {
+        for (int m = 0; m < NUM_METRICS; m++) {
+            ss_init(sketches[t].ss[m], counters);
+            cm_init(sketches[t].cm[m], cm_width, cm_depth);
+        }
+        sketches[t].num_edges = 0;
+    }
+
+    // Read the edge list: plain regular files are memory-mapped, compressed files and pipes are streamed.
+    mapped_file_t input;
+    bool streamed = true;
+    if (map_file(argv[1], &input) == 0) {
+        streamed = (detect_format(input.data, input.size) != FORMAT_PLAIN);
+        if (!streamed) parse_lines(input.data, input.size, BLOCK_SIZE, sketches);
+        unmap_file(&input);
+    }
+    if (streamed) {
+        FILE *input_file = fopen(argv[1], "r");
+        if (!input_file) {
+            cerr << "Error: could not open input file!\n";
+            return 1;
+        }
+        int status = parse_stream(input_file, sketches);
+        if (status == -1) {
+            cerr << "Error: unsupported compression format!\n";
+            return 1;
+        }
+        if (status == -2) {
+            cerr << "Error: could not read input file!\n";
+            return 1;
+        }
+        fclose(input_file);
+    }
+    long num_edges = 0;
+    for (int t = 0; t < num_threads; t++) num_edges += sketches[t].num_edges;
+
+    // Merge the sketches and write the results.
+    const char *suffixes[NUM_METRICS] = {"_out_str.tsv", "_in_str.tsv", "_pair_amount.tsv", "_pair_ntr.tsv"};
+    for (int m = 0; m < NUM_METRICS; m++) {
+        vector<result_t> top = merge_top(sketches, m, k);
+        string path = string(argv[2]) + suffixes[m];
+        FILE *output_file = fopen(path.c_str(), "w");
+        if (!output_file) {
+            cerr << "Error: could not open output file!\n";
+            return 1;
+        }
+        if (m < 2) fprintf(output_file, "%s\tlower_bound\tupper_bound\n", nm_column(map));
+        else fprintf(output_file, "from_%s\tto_%s\tlower_bound\tupper_bound\n", nm_column(map), nm_column(map));
+        for (const result_t &r : top) {
+            if (m < 2) fprintf(output_file, "%d\t%lf\t%lf\n", nm_label(map, (int) r.key), r.lower, r.upper);
+            else fprintf(output_file, "%d\t%d\t%lf\t%lf\n", nm_label(map, (int) (r.key >> 32)),
+                nm_label(map, (int) (uint32_t) r.key), r.lower, r.upper);
+        }
+        fclose(output_file);
+    }
+    if (map) nm_close(map);
+
+    auto end = high_resolution_clock::now();
+    auto elapsed = duration_cast<nanoseconds>(end - start);
+
+    // Print information about the program execution.
+    cout << num_edges << '\t' << elapsed.count() << '\n';
+    return 0;
+}
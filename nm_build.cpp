@@ -0,0 +1,117 @@
+/**
+ * @file nm_build.cpp
+ * @author Matteo Loporchio
+ * @date 2025-07-08
+ *
+ *  This program converts one or more node maps (produced by the graph builders)
+ *  into a binary node map (see nodemap.hpp), which can be memory-mapped by the other tools.
+ *
+ *  With a single node map, the binary node map preserves its node identifiers.
+ *  With several node maps (e.g., those of the temporal graphs), the program builds a global node map
+ *  including all their addresses: node identifiers are assigned in order of first appearance,
+ *  following the order of the input files and, within each file, the order of the identifiers.
+ *
+ *  INPUT:
+ *  The program requires the following arguments:
+ *      1. The path to the output file.
+ *      2. The path to a node map, i.e., a TSV file where each row includes:
+ *          - address;
+ *          - numeric identifier of the node.
+ *      3. (Optional) The paths to other node maps.
+ *
+ *  OUTPUT:
+ *  The binary node map.
+ *
+ *  PRINT:
+ *  The program prints the following information to stdout:
+ *      - number of nodes;
+ *      - elapsed time (in nanoseconds).
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+#include "io.hpp"
+#include "nodemap.hpp"
+
+using namespace std;
+using namespace std::chrono;
+
+/**
+ * @brief Reads a TSV node map.
+ *
+ * @param path the path to the node map
+ * @param addresses stores the address of each node (-1 if unknown)
+ * @return 0 on success, -1 if the file cannot be opened
+ */
+static int read_node_map(const char *path, vector<int32_t> &addresses) {
+    mapped_file_t input;
+    if (map_file(path, &input) < 0) return -1;
+    addresses.clear();
+    const char *p = input.data, *end = input.data + input.size;
+    while (p < end) {
+        const char *nl = (const char *) memchr(p, '\n', end - p);
+        if (!nl) nl = end;
+        char *q;
+        long address = strtol(p, &q, 10);
+        if (q < nl && *q == '\t') {
+            long id = strtol(q + 1, NULL, 10);
+            if (id >= 0) {
+                if ((size_t) id >= addresses.size()) addresses.resize(id + 1, -1);
+                addresses[id] = address;
+            }
+        }
+        p = nl + 1;
+    }
+    unmap_file(&input);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        cerr << "Usage: " << argv[0] << " <output_file> <node_map_file> [node_map_file ...]\n";
+        return 1;
+    }
+
+    auto start = high_resolution_clock::now();
+
+    vector<int32_t> addresses;
+    if (argc == 3) {
+        if (read_node_map(argv[2], addresses) < 0) {
+            cerr << "Error: could not open input file!\n";
+            return 1;
+        }
+    }
+    else {
+        // Merge the addresses of all node maps into a global identifier space.
+        unordered_map<int32_t, int32_t> global_ids;
+        vector<int32_t> local;
+        for (int i = 2; i < argc; i++) {
+            if (read_node_map(argv[i], local) < 0) {
+                cerr << "Error: could not open input file " << argv[i] << "!\n";
+                return 1;
+            }
+            for (int32_t address : local) {
+                if (address < 0 || global_ids.count(address)) continue;
+                global_ids[address] = addresses.size();
+                addresses.push_back(address);
+            }
+        }
+    }
+
+    if (nm_write(argv[1], addresses) < 0) {
+        cerr << "Error: could not write output file!\n";
+        return 1;
+    }
+
+    auto end = high_resolution_clock::now();
+    auto elapsed = duration_cast<nanoseconds>(end - start);
+
+    // Print information about the program execution.
+    cout << addresses.size() << '\t' << elapsed.count() << '\n';
+    return 0;
+}
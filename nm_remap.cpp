@@ -0,0 +1,148 @@
+/**
+ * @file nm_remap.cpp
+ * @author Matteo Loporchio
+ * @date 2025-07-08
+ *
+ *  This program translates the node identifiers of a result file (e.g., the output of
+ *  one of the tools for a temporal graph) into the identifiers of a global node map,
+ *  or into addresses, without loading the node maps as text.
+ *  The node identifiers must be in the first columns of the file. Each identifier is translated into
+ *  an address with the node map of the graph and then into a global identifier with the global node map.
+ *  Lines that do not start with a number (e.g., the header) are copied, but the names of the columns
+ *  with node identifiers ending with "node_id" or "address" (e.g., "from_node_id") are rewritten for the output.
+ *
+ *  INPUT:
+ *  The program requires the following arguments:
+ *      1. The path to the input TSV file.
+ *      2. The path to the output TSV file.
+ *      3. The path to the binary node map of the graph.
+ *      4. The path to the global binary node map or "-" to write addresses.
+ *      5. (Optional) The number of columns with node identifiers (default: 1).
+ *
+ *  OUTPUT:
+ *  A copy of the input file where the node identifiers are replaced by global identifiers (or addresses).
+ *  Nodes that cannot be translated are replaced by -1.
+ *
+ *  PRINT:
+ *  The program prints the following information to stdout:
+ *      - number of lines translated;
+ *      - number of identifiers that could not be translated;
+ *      - elapsed time (in nanoseconds).
+ */
+
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include "io.hpp"
+#include "nodemap.hpp"
+
+using namespace std;
+using namespace std::chrono;
+
+/**
+ * @brief Writes the name of a column of the header, replacing the suffix "node_id" or "address" (if any).
+ *
+ * @param p beginning of the name
+ * @param end end of the name
+ * @param column the new suffix
+ * @param output_file the output stream
+ */
+static void write_column_name(const char *p, const char *end, const char *column, FILE *output_file) {
+    const char *suffixes[] = {"node_id", "address"};
+    for (const char *suffix : suffixes) {
+        size_t len = strlen(suffix);
+        if ((size_t) (end - p) >= len && !memcmp(end - len, suffix, len)) {
+            fwrite(p, 1, end - p - len, output_file);
+            fputs(column, output_file);
+            return;
+        }
+    }
+    fwrite(p, 1, end - p, output_file);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 5) {
+        cerr << "Usage: " << argv[0] << " <input_file> <output_file> <node_map_file> <global_node_map_file|-> [num_columns]\n";
+        return 1;
+    }
+    int num_columns = (argc > 5) ? atoi(argv[5]) : 1;
+
+    auto start = high_resolution_clock::now();
+
+    node_map_t local_map, global_map;
+    if (nm_open(argv[3], &local_map) < 0) {
+        cerr << "Error: could not open node map file!\n";
+        return 1;
+    }
+    bool global = strcmp(argv[4], "-");
+    if (global && nm_open(argv[4], &global_map) < 0) {
+        cerr << "Error: could not open global node map file!\n";
+        return 1;
+    }
+    mapped_file_t input;
+    if (map_file(argv[1], &input) < 0) {
+        cerr << "Error: could not open input file!\n";
+        return 1;
+    }
+    FILE *output_file = fopen(argv[2], "w");
+    if (!output_file) {
+        cerr << "Error: could not open output file!\n";
+        return 1;
+    }
+
+    // Global identifiers are node identifiers, otherwise the output contains addresses.
+    const char *column = nm_column(global ? NULL : &local_map);
+    long num_lines = 0, num_missing = 0;
+    const char *p = input.data, *end = input.data + input.size;
+    while (p < end) {
+        const char *nl = (const char *) memchr(p, '\n', end - p);
+        const char *next = nl ? nl + 1 : end;
+        if (!isdigit((unsigned char) *p) && !(*p == '-' && p + 1 < end && isdigit((unsigned char) p[1]))) {
+            for (int c = 0; c < num_columns && p < next; c++) {
+                const char *q = p;
+                while (q < next && *q != '\t' && *q != '\n' && *q != '\r') q++;
+                write_column_name(p, q, column, output_file);
+                p = q;
+                if (p < next && *p == '\t') {
+                    fputc('\t', output_file);
+                    p++;
+                }
+                else break;
+            }
+            fwrite(p, 1, next - p, output_file);
+            p = next;
+            continue;
+        }
+        for (int c = 0; c < num_columns && p < next; c++) {
+            char *q;
+            long id = strtol(p, &q, 10);
+            int label = nm_label(&local_map, id);
+            if (global && label >= 0) label = nm_lookup(&global_map, label);
+            if (label < 0) num_missing++;
+            fprintf(output_file, "%d", label);
+            p = q;
+            if (p < next && *p == '\t') {
+                fputc('\t', output_file);
+                p++;
+            }
+            else break;
+        }
+        fwrite(p, 1, next - p, output_file);
+        num_lines++;
+        p = next;
+    }
+    fclose(output_file);
+    unmap_file(&input);
+    nm_close(&local_map);
+    if (global) nm_close(&global_map);
+
+    auto stop = high_resolution_clock::now();
+    auto elapsed = duration_cast<nanoseconds>(stop - start);
+
+    // Print information about the program execution.
+    cout << num_lines << '\t' << num_missing << '\t' << elapsed.count() << '\n';
+    return 0;
+}
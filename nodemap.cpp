@@ -0,0 +1,132 @@
+/**
+ * @file nodemap.cpp
+ * @author Matteo Loporchio
+ * @date 2025-07-08
+ * 
+ *  This file contains the implementation of functions for reading and writing binary node maps.
+ */
+
+#include "nodemap.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/mman.h>
+
+/**
+ * @brief Writes a binary node map.
+ * 
+ * @param path the path to the output file
+ * @param addresses the address of each node (-1 if unknown)
+ * @return 0 on success, -1 if the file cannot be written
+ */
+int nm_write(const char *path, const std::vector<int32_t> &addresses) {
+    std::vector<nm_entry_t> index;
+    index.reserve(addresses.size());
+    for (size_t i = 0; i < addresses.size(); i++) {
+        if (addresses[i] < 0) continue;
+        nm_entry_t e = {addresses[i], (int32_t) i};
+        index.push_back(e);
+    }
+    std::sort(index.begin(), index.end(), [](const nm_entry_t &a, const nm_entry_t &b) {
+        return a.address < b.address || (a.address == b.address && a.node_id < b.node_id);
+    });
+    FILE *output_file = fopen(path, "wb");
+    if (!output_file) return -1;
+    nm_header_t header = {NM_MAGIC, (int64_t) addresses.size()};
+    int64_t num_entries = index.size();
+    bool ok = fwrite(&header, sizeof(header), 1, output_file) == 1
+        && fwrite(addresses.data(), sizeof(int32_t), addresses.size(), output_file) == addresses.size()
+        && fwrite(&num_entries, sizeof(num_entries), 1, output_file) == 1
+        && fwrite(index.data(), sizeof(nm_entry_t), index.size(), output_file) == index.size();
+    if (fclose(output_file) != 0) ok = false;
+    return ok ? 0 : -1;
+}
+
+/**
+ * @brief Opens a binary node map.
+ * 
+ * @param path the path to the node map file
+ * @param map stores the node map
+ * @return 0 on success, -1 if the file cannot be opened or is not a valid node map
+ */
+int nm_open(const char *path, node_map_t *map) {
+    if (map_file(path, &map->file) < 0) return -1;
+    const char *data = map->file.data;
+    size_t size = map->file.size;
+    nm_header_t header;
+    if (size < sizeof(header)) {
+        nm_close(map);
+        return -1;
+    }
+    memcpy(&header, data, sizeof(header));
+    // The counts are checked against the file size before computing any offset, to avoid overflows.
+    if (header.magic != NM_MAGIC || header.num_nodes < 0
+        || (uint64_t) header.num_nodes > (size - sizeof(header)) / sizeof(int32_t)) {
+        nm_close(map);
+        return -1;
+    }
+    size_t index_pos = sizeof(header) + header.num_nodes * sizeof(int32_t);
+    if (size < index_pos + sizeof(int64_t)) {
+        nm_close(map);
+        return -1;
+    }
+    int64_t num_entries;
+    memcpy(&num_entries, data + index_pos, sizeof(num_entries));
+    if (num_entries < 0 || (uint64_t) num_entries > (size - index_pos - sizeof(int64_t)) / sizeof(nm_entry_t)
+        || size != index_pos + sizeof(int64_t) + num_entries * sizeof(nm_entry_t)) {
+        nm_close(map);
+        return -1;
+    }
+    // Lookups access the file at random positions.
+    madvise((void *) data, size, MADV_RANDOM);
+    map->num_nodes = header.num_nodes;
+    map->addresses = (const int32_t *) (data + sizeof(header));
+    map->index = (const nm_entry_t *) (data + index_pos + sizeof(int64_t));
+    map->num_entries = num_entries;
+    return 0;
+}
+
+/**
+ * @brief Opens the binary node map given as an optional argument of a program, to write addresses
+ *  instead of node identifiers. The node map is not used if the argument is missing or "-".
+ *  If the file cannot be opened or is not a valid node map, the program exits with an error.
+ * 
+ * @param argc the number of arguments of the program
+ * @param argv the arguments of the program
+ * @param idx the position of the node map argument
+ * @param map stores the node map
+ * @return map if the node map is given, NULL otherwise
+ */
+node_map_t *nm_open_optional(int argc, char **argv, int idx, node_map_t *map) {
+    if (argc <= idx || !strcmp(argv[idx], "-")) return NULL;
+    if (nm_open(argv[idx], map) < 0) {
+        fprintf(stderr, "Error: could not open node map file!\n");
+        exit(1);
+    }
+    return map;
+}
+
+/**
+ * @brief Releases a node map.
+ * 
+ * @param map the node map
+ */
+void nm_close(node_map_t *map) {
+    unmap_file(&map->file);
+}
+
+/**
+ * @brief Returns the node corresponding to an address.
+ * 
+ * @param map the node map
+ * @param address the address
+ * @return the node identifier, or -1 if the address is not in the map
+ */
+int nm_lookup(const node_map_t *map, int32_t address) {
+    const nm_entry_t *begin = map->index, *end = map->index + map->num_entries;
+    const nm_entry_t *it = std::lower_bound(begin, end, address, [](const nm_entry_t &e, int32_t a) {
+        return e.address < a;
+    });
+    return (it != end && it->address == address) ? it->node_id : -1;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file nodemap.hpp
+ * @author Matteo Loporchio
+ * @date 2025-07-08
+ * 
+ *  This file contains the definitions of functions for reading and writing binary node maps.
+ *  A node map associates each node of a graph (i.e., a dense numeric identifier) with its address.
+ *  The binary file is memory-mapped and includes the following sections:
+ *      1) a header with a magic number and the number of nodes;
+ *      2) the address of each node, indexed by node identifier (32-bit integers);
+ *      3) the number of known addresses (64-bit integer), followed by the list of
+ *         (address, node identifier) pairs sorted by address.
+ *  Nodes are thus translated into addresses in constant time, and addresses into nodes by binary search.
+ */
+
+#ifndef NODEMAP_H
+#define NODEMAP_H
+
+#include <cstdint>
+#include <vector>
+#include "io.hpp"
+
+#define NM_MAGIC 0x314d4e544147ULL // "GATNM1" (in native byte order)
+
+/**
+ * @brief Header of the binary node map file.
+ */
+typedef struct {
+    uint64_t magic;
+    int64_t num_nodes;
+} nm_header_t;
+
+/**
+ * @brief An entry of the address index.
+ */
+typedef struct {
+    int32_t address;
+    int32_t node_id;
+} nm_entry_t;
+
+/**
+ * @brief A memory-mapped node map.
+ */
+typedef struct {
+    mapped_file_t file;
+    int64_t num_nodes;
+    const int32_t *addresses; // address of each node (-1 if unknown)
+    const nm_entry_t *index; // (address, node identifier) pairs sorted by address
+    int64_t num_entries; // number of pairs in the index
+} node_map_t;
+
+/**
+ * @brief Writes a binary node map.
+ * 
+ * @param path the path to the output file
+ * @param addresses the address of each node (-1 if unknown)
+ * @return 0 on success, -1 if the file cannot be written
+ */
+int nm_write(const char *path, const std::vector<int32_t> &addresses);
+
+/**
+ * @brief Opens a binary node map.
+ * 
+ * @param path the path to the node map file
+ * @param map stores the node map
+ * @return 0 on success, -1 if the file cannot be opened or is not a valid node map
+ */
+int nm_open(const char *path, node_map_t *map);
+
+/**
+ * @brief Opens the binary node map given as an optional argument of a program, to write addresses
+ *  instead of node identifiers. The node map is not used if the argument is missing or "-".
+ *  If the file cannot be opened or is not a valid node map, the program exits with an error.
+ * 
+ * @param argc the number of arguments of the program
+ * @param argv the arguments of the program
+ * @param idx the position of the node map argument
+ * @param map stores the node map
+ * @return map if the node map is given, NULL otherwise
+ */
+node_map_t *nm_open_optional(int argc, char **argv, int idx, node_map_t *map);
+
+/**
+ * @brief Releases a node map.
+ * 
+ * @param map the node map
+ */
+void nm_close(node_map_t *map);
+
+/**
+ * @brief Returns the node corresponding to an address.
+ * 
+ * @param map the node map
+ * @param address the address
+ * @return the node identifier, or -1 if the address is not in the map
+ */
+int nm_lookup(const node_map_t *map, int32_t address);
+
+/**
+ * @brief Returns the label of a node in the output files: its address if a node map is given
+ *  (-1 if the node is not in the map) or its identifier otherwise.
+ */
+static inline int nm_label(const node_map_t *map, int node_id) {
+    if (!map) return node_id;
+    return (node_id >= 0 && node_id < map->num_nodes) ? map->addresses[node_id] : -1;
+}
+
+/**
+ * @brief Returns the name of the column with the labels of the nodes in the output files.
+ */
+static inline const char *nm_column(const node_map_t *map) {
+    return map ? "address" : "node_id";
+}
+
+#endif
@@ -0,0 +1,315 @@
+/**
+ * @file partition.cpp
+ * @author Matteo Loporchio
+ * @date 2025-06-17
+ *
+ *  This program reads the ERC-20 transfer dataset (see: https://zenodo.org/records/10644077)
+ *  and extracts the transfers of several contracts in a single pass, creating one file
+ *  for each contract with the same content produced by Filter.java.
+ *
+ *  The transfer file and the values file are memory-mapped and read together: line i
+ *  of the values file contains the (unscaled) amount of the transfer on line i of the transfer file.
+ *  The values file is first split into blocks whose lines are counted in parallel, so that the value
+ *  of any transfer can be found by scanning a single block. The transfer file is then processed
+ *  in batches of blocks. For each batch, the blocks are parsed in parallel
+ *  and each selected transfer is appended to the buffer of its contract. The buffers are then written
+ *  to the output files, following the original order of the transfers, with one large write per block.
+ *  Amounts are divided by 10^decimals, where decimals depends on the contract.
+ *
+ *  INPUT:
+ *  The program requires the following arguments:
+ *      1. The path to the ERC-20 transfer file.
+ *      2. The path to the ERC-20 transfer values file.
+ *      3. The path to the contract list, i.e., a TSV file where each row includes:
+ *          - numeric identifier of the contract;
+ *          - number of decimals of the contract;
+ *          - name of the contract (used for the output files).
+ *      4. The path to the output directory.
+ *      5. (Optional) "binary" to also write the binary edge stream of each contract.
+ *
+ *  OUTPUT:
+ *  For each contract, the program creates the file <name>.csv in the output directory.
+ *  Each line represents a token transfer and includes the following fields:
+ *      1) block identifier in which the transfer occurred;
+ *      2) numeric identifier of the contract that produced the event;
+ *      3) numeric identifier of the sender of the transfer;
+ *      4) numeric identifier of the recipient of the transfer;
+ *      5) amount of tokens transferred.
+ *  If requested, the program also creates the file <name>.bin, where each transfer is stored as
+ *  a 20-byte record with the following fields (in native byte order):
+ *      - block identifier (32-bit integer);
+ *      - numeric identifier of the sender (32-bit integer);
+ *      - numeric identifier of the recipient (32-bit integer);
+ *      - amount of tokens transferred (64-bit floating point number).
+ *
+ *  PRINT:
+ *  The program prints the following information to stdout:
+ *      - number of transfers read;
+ *      - number of transfers written (for all contracts);
+ *      - elapsed time (in nanoseconds).
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <omp.h>
+#include "io.hpp"
+
+#define BLOCK_SIZE (16 << 20) // target size of each block of the transfer file (in bytes)
+#define BLOCKS_PER_THREAD 4 // number of blocks processed by each thread in a batch
+
+using namespace std;
+using namespace std::chrono;
+
+/**
+ * @brief A contract to be extracted.
+ */
+typedef struct {
+    int id;
+    int decimals;
+    string name;
+    FILE *csv_file;
+    FILE *bin_file;
+} contract_t;
+
+/**
+ * @brief Returns a pointer to the beginning of the line following the one starting at p
+ *  (or end, if there are no more lines).
+ */
+static inline const char *next_line(const char *p, const char *end) {
+    const char *nl = (const char *) memchr(p, '\n', end - p);
+    return nl ? nl + 1 : end;
+}
+
+/**
+ * @brief Converts an unscaled amount (a decimal integer) into the number of tokens.
+ *
+ * @param p beginning of the amount
+ * @param end end of the amount
+ * @param decimals number of decimals of the token
+ * @return the amount divided by 10^decimals (correctly rounded)
+ */
+static double parse_amount(const char *p, const char *end, int decimals) {
+    // The conversion is delegated to strtod, by writing the amount in scientific notation.
+    char buf[128];
+    string tmp;
+    size_t len = end - p;
+    char *s = buf;
+    if (len + 16 > sizeof(buf)) {
+        tmp.resize(len + 16);
+        s = &tmp[0];
+    }
+    memcpy(s, p, len);
+    snprintf(s + len, 16, "e-%d", decimals);
+    return strtod(s, NULL);
+}
+
+/**
+ * @brief Finds the beginning of a line of a file split into blocks.
+ *
+ * @param data the content of the file
+ * @param size the size of the file
+ * @param bounds offsets of the blocks (num_blocks + 1 entries)
+ * @param first_line index of the first line of each block (num_blocks + 1 entries, the last one is the number of lines)
+ * @param line the index of the line
+ * @return a pointer to the beginning of the line (or to the end of the file, if there is no such line)
+ */
+static const char *find_line(const char *data, size_t size, const vector<size_t> &bounds,
+    const vector<long> &first_line, long line) {
+    if (line >= first_line.back()) return data + size;
+    size_t b = upper_bound(first_line.begin(), first_line.end(), line) - first_line.begin() - 1;
+    const char *p = data + bounds[b];
+    for (long i = first_line[b]; i < line; i++) p = next_line(p, data + size);
+    return p;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 5) {
+        cerr << "Usage: " << argv[0] << " <transfer_file> <values_file> <contract_list_file> <output_dir> [binary]\n";
+        return 1;
+    }
+    bool binary = (argc > 5 && !strcmp(argv[5], "binary"));
+
+    auto start = high_resolution_clock::now();
+
+    // Read the list of contracts and create the output files.
+    FILE *list_file = fopen(argv[3], "r");
+    if (!list_file) {
+        cerr << "Error: could not open contract list file!\n";
+        return 1;
+    }
+    vector<contract_t> contracts;
+    char *line_buf = NULL;
+    size_t line_size = 0;
+    while (getline(&line_buf, &line_size, list_file) > 0) {
+        int id, decimals;
+        char name[1024];
+        if (sscanf(line_buf, "%d\t%d\t%1023s", &id, &decimals, name) != 3) continue;
+        contract_t c;
+        c.id = id;
+        c.decimals = decimals;
+        c.name = name;
+        string path = string(argv[4]) + "/" + name;
+        c.csv_file = fopen((path + ".csv").c_str(), "w");
+        c.bin_file = binary ? fopen((path + ".bin").c_str(), "wb") : NULL;
+        if (!c.csv_file || (binary && !c.bin_file)) {
+            cerr << "Error: could not open output file for contract " << name << "!\n";
+            return 1;
+        }
+        contracts.push_back(c);
+    }
+    free(line_buf);
+    fclose(list_file);
+    int num_contracts = contracts.size();
+
+    // Map each contract identifier to its position in the list.
+    int max_id = -1;
+    for (int c = 0; c < num_contracts; c++) max_id = max(max_id, contracts[c].id);
+    vector<int> slot(max_id + 1, -1);
+    for (int c = 0; c < num_contracts; c++) {
+        if (contracts[c].id < 0 || slot[contracts[c].id] >= 0) {
+            cerr << "Error: invalid or duplicate contract identifier " << contracts[c].id << "!\n";
+            return 1;
+        }
+        slot[contracts[c].id] = c;
+    }
+
+    // Map the input files into memory.
+    mapped_file_t transfers, values;
+    if (map_file(argv[1], &transfers) < 0) {
+        cerr << "Error: could not open transfer file!\n";
+        return 1;
+    }
+    if (map_file(argv[2], &values) < 0) {
+        cerr << "Error: could not open values file!\n";
+        return 1;
+    }
+
+    // Split the values file into blocks and find the index of the first line of each block.
+    const char *tdata = transfers.data;
+    const char *vdata = values.data;
+    size_t max_value_blocks = values.size / BLOCK_SIZE + 1;
+    vector<size_t> value_bounds(max_value_blocks + 1);
+    size_t num_value_blocks = split_lines(vdata, values.size, BLOCK_SIZE, &value_bounds[0], max_value_blocks);
+    value_bounds.resize(num_value_blocks + 1);
+    vector<long> value_lines(num_value_blocks + 1, 0);
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (size_t b = 0; b < num_value_blocks; b++) {
+        long count = 0;
+        for (const char *p = vdata + value_bounds[b]; p < vdata + value_bounds[b + 1]; p = next_line(p, vdata + value_bounds[b + 1])) count++;
+        value_lines[b + 1] = count;
+    }
+    for (size_t b = 0; b < num_value_blocks; b++) value_lines[b + 1] += value_lines[b];
+
+    int num_threads = omp_get_max_threads();
+    size_t max_blocks = BLOCKS_PER_THREAD * num_threads;
+    vector<size_t> bounds(max_blocks + 1);
+    vector<long> first_line(max_blocks + 1);
+    vector<vector<string>> csv_buf(max_blocks, vector<string>(num_contracts));
+    vector<vector<string>> bin_buf(max_blocks, vector<string>(binary ? num_contracts : 0));
+    size_t tpos = 0;
+    long tline = 0, num_transfers = 0, num_selected = 0;
+    while (tpos < transfers.size && tline < value_lines.back()) {
+        // Split the next part of the transfer file into blocks and count their lines.
+        size_t num_blocks = split_lines(tdata + tpos, transfers.size - tpos, BLOCK_SIZE, &bounds[0], max_blocks);
+        for (size_t b = 0; b <= num_blocks; b++) bounds[b] += tpos;
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (size_t b = 0; b < num_blocks; b++) {
+            long count = 0;
+            for (const char *p = tdata + bounds[b]; p < tdata + bounds[b + 1]; p = next_line(p, tdata + bounds[b + 1])) count++;
+            first_line[b + 1] = count;
+        }
+        first_line[0] = tline;
+        for (size_t b = 0; b < num_blocks; b++) first_line[b + 1] += first_line[b];
+
+        // Parse the blocks in parallel.
+        #pragma omp parallel for schedule(dynamic, 1) reduction(+:num_transfers, num_selected)
+        for (size_t b = 0; b < num_blocks; b++) {
+            const char *tp = tdata + bounds[b], *tend = tdata + bounds[b + 1];
+            // Find the value of the first transfer of the block.
+            const char *vp = find_line(vdata, values.size, value_bounds, value_lines, first_line[b]);
+            const char *vend = vdata + values.size;
+            vector<string> &csv = csv_buf[b];
+            vector<string> &bin = bin_buf[b];
+            while (tp < tend && vp < vend) {
+                const char *tnext = next_line(tp, tend);
+                const char *vnext = next_line(vp, vend);
+                num_transfers++;
+                // Fields: block, contract, sender, recipient.
+                const char *f0 = tp;
+                const char *f1 = (const char *) memchr(f0, ',', tnext - f0);
+                if (!f1) { tp = tnext; vp = vnext; continue; }
+                f1++;
+                char *f2;
+                long contract_id = strtol(f1, &f2, 10);
+                if (contract_id < 0 || contract_id > max_id || slot[contract_id] < 0 || *f2 != ',') {
+                    tp = tnext; vp = vnext;
+                    continue;
+                }
+                int c = slot[contract_id];
+                f2++;
+                const char *f3 = (const char *) memchr(f2, ',', tnext - f2);
+                if (!f3) { tp = tnext; vp = vnext; continue; }
+                f3++;
+                const char *f3_end = f3;
+                while (f3_end < tnext && *f3_end != ',' && *f3_end != '\n' && *f3_end != '\r') f3_end++;
+                const char *v_end = vnext;
+                while (v_end > vp && (v_end[-1] == '\n' || v_end[-1] == '\r')) v_end--;
+                double value = parse_amount(vp, v_end, contracts[c].decimals);
+                // Append the transfer to the buffer of its contract.
+                string &out = csv[c];
+                out.append(f0, f1 - f0);
+                out.append(f1, f2 - f1);
+                out.append(f2, f3 - f2);
+                out.append(f3, f3_end - f3);
+                char num_buf[64];
+                int len = snprintf(num_buf, sizeof(num_buf), ",%f\n", value);
+                out.append(num_buf, len);
+                if (binary) {
+                    int32_t fields[3] = {(int32_t) atoi(f0), (int32_t) atoi(f2), (int32_t) atoi(f3)};
+                    bin[c].append((const char *) fields, sizeof(fields));
+                    bin[c].append((const char *) &value, sizeof(value));
+                }
+                num_selected++;
+                tp = tnext;
+                vp = vnext;
+            }
+        }
+
+        // Write the buffers of each contract, following the order of the blocks.
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (int c = 0; c < num_contracts; c++) {
+            for (size_t b = 0; b < num_blocks; b++) {
+                fwrite(csv_buf[b][c].data(), 1, csv_buf[b][c].size(), contracts[c].csv_file);
+                csv_buf[b][c].clear();
+                if (binary) {
+                    fwrite(bin_buf[b][c].data(), 1, bin_buf[b][c].size(), contracts[c].bin_file);
+                    bin_buf[b][c].clear();
+                }
+            }
+        }
+        tpos = bounds[num_blocks];
+        tline = first_line[num_blocks];
+    }
+
+    // Close all files.
+    for (int c = 0; c < num_contracts; c++) {
+        fclose(contracts[c].csv_file);
+        if (binary) fclose(contracts[c].bin_file);
+    }
+    unmap_file(&transfers);
+    unmap_file(&values);
+
+    auto end = high_resolution_clock::now();
+    auto elapsed = duration_cast<nanoseconds>(end - start);
+
+    // Print information about the program execution.
+    cout << num_transfers << '\t' << num_selected << '\t' << elapsed.count() << '\n';
+    return 0;
+}
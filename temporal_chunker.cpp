@@ -0,0 +1,369 @@
+/**
+ * @file temporal_chunker.cpp
+ * @author Matteo Loporchio
+ * @date 2025-06-24
+ *
+ *  This program reads the ERC-20 transfer list of a contract and splits the transfers
+ *  in contiguous chunks based on their timestamp, producing the same chunks as temporal_builder.py.
+ *  The timestamp of each transfer is obtained in constant time from the binary block timestamp index
+ *  (created with ts_index), which is memory-mapped together with the transfer list.
+ *  Transfers whose block timestamp is unknown are ignored.
+ *
+ *  Chunks are aligned as in pandas: fixed-width chunks (seconds, minutes, hours or days) start at
+ *  midnight of the day of the first transfer and are labelled with their initial timestamp,
+ *  while monthly chunks follow the calendar, start at the month of the first transfer
+ *  and are labelled with the last day of their last month.
+ *
+ *  Instead of writing the transfer list of each chunk, the program can directly build the
+ *  collapsed graph of each chunk, with the same output as CollapsedGraphBuilder.java
+ *  (this requires the transfer list to be sorted by block).
+ *
+ *  INPUT:
+ *  The program requires the following arguments:
+ *      1. The path to the ERC-20 transfer list.
+ *      2. The path to the block timestamp index.
+ *      3. The base name for each chunk file.
+ *      4. The path to the chunk mapping file.
+ *      5. The width of each chunk: a number followed by a unit among
+ *         "s" (seconds), "min" (minutes), "h" (hours), "D" (days) and "m" or "M" (months), e.g., "1D".
+ *      6. (Optional) "graph" followed by the path to the build statistics file,
+ *         to build the collapsed graph of each chunk.
+ *
+ *  OUTPUT:
+ *  The program produces:
+ *      -   One transfer list for each chunk (<base_name>_<i>.csv), with the same lines of the input list,
+ *          or, for the "graph" option, the weighted edge list (<base_name>_<i>_cg_el.tsv) and the node map
+ *          (<base_name>_<i>_cg_nm.tsv) of the collapsed graph of each chunk, plus a TSV file with the
+ *          number of nodes, number of edges and elapsed time (in nanoseconds) for each chunk.
+ *      -   A TSV file containing the mapping between chunks and their time ranges.
+ *          The file has two columns representing:
+ *          -   the numeric identifier of the chunk;
+ *          -   the timestamp used as label for the chunk time range.
+ *
+ *  PRINT:
+ *  The program prints the number of chunks created to stdout.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "io.hpp"
+
+#define OUTPUT_BUFFER_SIZE (4 << 20) // size of the buffer of each output file (in bytes)
+
+using namespace std;
+using namespace std::chrono;
+
+/**
+ * @brief Width of a chunk: either a fixed number of seconds or a number of calendar months.
+ */
+typedef struct {
+    long long seconds;
+    int months;
+} chunk_width_t;
+
+/**
+ * @brief A transfer of the collapsed graph under construction (as in MultigraphEdge.java).
+ */
+typedef struct {
+    int from_id;
+    int to_id;
+    double value;
+} edge_t;
+
+/**
+ * @brief Parses the width of a chunk.
+ * @return 0 on success, -1 if the width is not valid
+ */
+static int parse_width(const char *s, chunk_width_t *width) {
+    char *unit;
+    long n = strtol(s, &unit, 10);
+    if (unit == s) n = 1;
+    if (n <= 0) return -1;
+    width->seconds = 0;
+    width->months = 0;
+    if (!strcmp(unit, "s") || !strcmp(unit, "S")) width->seconds = n;
+    else if (!strcmp(unit, "min") || !strcmp(unit, "T")) width->seconds = 60 * n;
+    else if (!strcmp(unit, "h") || !strcmp(unit, "H")) width->seconds = 3600 * n;
+    else if (!strcmp(unit, "d") || !strcmp(unit, "D")) width->seconds = 86400 * n;
+    else if (!strcmp(unit, "m") || !strcmp(unit, "M")) width->months = n;
+    else return -1;
+    return 0;
+}
+
+/**
+ * @brief Returns the number of months elapsed from January 1970 to the month of a timestamp.
+ */
+static long long month_of(long long timestamp) {
+    time_t t = timestamp;
+    struct tm tm;
+    gmtime_r(&t, &tm);
+    return (tm.tm_year - 70) * 12LL + tm.tm_mon;
+}
+
+/**
+ * @brief Returns the chunk (relative to the origin) containing a timestamp.
+ *  Fixed-width chunks are counted from midnight of the day of the first transfer (the origin, in seconds),
+ *  monthly chunks from the month of the first transfer (the origin, in months from January 1970).
+ */
+static long long chunk_of(long long timestamp, long long origin, const chunk_width_t &width) {
+    if (width.months > 0) return (month_of(timestamp) - origin) / width.months;
+    long long d = timestamp - origin;
+    return (d >= 0) ? d / width.seconds : -((-d + width.seconds - 1) / width.seconds);
+}
+
+/**
+ * @brief Formats the label of a chunk (relative to the origin).
+ */
+static string chunk_label(long long chunk, long long origin, const chunk_width_t &width) {
+    struct tm tm;
+    if (width.months > 0) {
+        // Last day of the last month of the chunk: the day before the first day of the next chunk.
+        long long next = origin + (chunk + 1) * width.months;
+        memset(&tm, 0, sizeof(tm));
+        tm.tm_year = next / 12 + 70;
+        tm.tm_mon = next % 12;
+        tm.tm_mday = 1;
+        time_t t = timegm(&tm) - 86400;
+        gmtime_r(&t, &tm);
+    }
+    else {
+        time_t t = origin + chunk * width.seconds;
+        gmtime_r(&t, &tm);
+    }
+    char buf[64];
+    strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+    return string(buf);
+}
+
+/**
+ * @brief Builds the collapsed graph of a chunk and writes it to the corresponding files
+ *  (as in CollapsedGraphBuilder.java).
+ *
+ * @param edges the transfers of the chunk (between node identifiers)
+ * @param addresses the address of each node identifier
+ * @param base_name the base name of the chunk files
+ * @param chunk the chunk identifier
+ * @param stats_file the build statistics file
+ * @param start the instant when the construction of the chunk started
+ * @return 0 on success, -1 if the files cannot be created
+ */
+static int write_graph(vector<edge_t> &edges, const vector<int> &addresses, const char *base_name,
+long long chunk, FILE *stats_file, high_resolution_clock::time_point start) {
+    string prefix = string(base_name) + "_" + to_string(chunk);
+    FILE *edge_file = fopen((prefix + "_cg_el.tsv").c_str(), "w");
+    FILE *node_file = fopen((prefix + "_cg_nm.tsv").c_str(), "w");
+    if (!edge_file || !node_file) return -1;
+    stable_sort(edges.begin(), edges.end(), [](const edge_t &a, const edge_t &b) {
+        return (a.from_id != b.from_id) ? (a.from_id < b.from_id) : (a.to_id < b.to_id);
+    });
+    long num_edges = 0;
+    for (size_t i = 0; i < edges.size(); ) {
+        size_t j = i;
+        double total = 0;
+        while (j < edges.size() && edges[j].from_id == edges[i].from_id && edges[j].to_id == edges[i].to_id)
+            total += edges[j++].value;
+        fprintf(edge_file, "%d\t%d\t%ld\t%f\n", edges[i].from_id, edges[i].to_id, (long) (j - i), total);
+        num_edges++;
+        i = j;
+    }
+    for (size_t id = 0; id < addresses.size(); id++) fprintf(node_file, "%d\t%zu\n", addresses[id], id);
+    fclose(edge_file);
+    fclose(node_file);
+    auto end = high_resolution_clock::now();
+    fprintf(stats_file, "%lld\t%zu\t%ld\t%lld\n", chunk, addresses.size(), num_edges,
+    (long long) duration_cast<nanoseconds>(end - start).count());
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 6 || (argc > 6 && (strcmp(argv[6], "graph") || argc < 8))) {
+        cerr << "Usage: " << argv[0] << " <transfer_file> <index_file> <chunk_base_name> <chunk_map_file> <chunk_size> [graph <stats_file>]\n";
+        return 1;
+    }
+    const char *base_name = argv[3];
+    bool graph = (argc > 6);
+    chunk_width_t width;
+    if (parse_width(argv[5], &width) < 0) {
+        cerr << "Error: invalid chunk size!\n";
+        return 1;
+    }
+
+    // Map the transfer list and the timestamp index into memory.
+    mapped_file_t transfers, index_file;
+    if (map_file(argv[1], &transfers) < 0) {
+        cerr << "Error: could not open input file!\n";
+        return 1;
+    }
+    if (map_file(argv[2], &index_file) < 0) {
+        cerr << "Error: could not open index file!\n";
+        return 1;
+    }
+    const int64_t *index = (const int64_t *) index_file.data;
+    long long index_size = index_file.size / sizeof(int64_t);
+    const char *data = transfers.data, *data_end = transfers.data + transfers.size;
+
+    // Find the time range of the transfers (the first field of each line is the block identifier).
+    long long min_ts = LLONG_MAX, max_ts = LLONG_MIN;
+    for (const char *p = data; p < data_end; ) {
+        const char *nl = (const char *) memchr(p, '\n', data_end - p);
+        if (!nl) nl = data_end;
+        long long block_id = strtoll(p, NULL, 10);
+        if (block_id >= 0 && block_id < index_size && index[block_id] >= 0) {
+            min_ts = min(min_ts, (long long) index[block_id]);
+            max_ts = max(max_ts, (long long) index[block_id]);
+        }
+        p = nl + 1;
+    }
+    long long origin = 0, first_chunk = 0, num_chunks = 0;
+    if (min_ts <= max_ts) {
+        origin = (width.months > 0) ? month_of(min_ts) : min_ts - ((min_ts % 86400) + 86400) % 86400;
+        first_chunk = chunk_of(min_ts, origin, width);
+        num_chunks = chunk_of(max_ts, origin, width) - first_chunk + 1;
+    }
+
+    // Write the chunk mapping file.
+    FILE *map_file_out = fopen(argv[4], "w");
+    if (!map_file_out) {
+        cerr << "Error: could not open chunk map file!\n";
+        return 1;
+    }
+    fprintf(map_file_out, "chunk_id\ttimestamp\n");
+    for (long long i = 0; i < num_chunks; i++)
+        fprintf(map_file_out, "%lld\t%s\n", i, chunk_label(first_chunk + i, origin, width).c_str());
+    fclose(map_file_out);
+
+    FILE *stats_file = NULL;
+    if (graph) {
+        stats_file = fopen(argv[7], "w");
+        if (!stats_file) {
+            cerr << "Error: could not open statistics file!\n";
+            return 1;
+        }
+        fprintf(stats_file, "chunk_id\tnum_nodes\tnum_edges\telapsed_time\n");
+    }
+
+    // Route each transfer to its chunk.
+    vector<char> created(num_chunks, 0);
+    vector<char> buffer(OUTPUT_BUFFER_SIZE);
+    long long current = -1;
+    FILE *chunk_file = NULL;
+    unordered_map<int, int> node_ids;
+    vector<int> addresses;
+    vector<edge_t> edges;
+    auto chunk_start = high_resolution_clock::now();
+    for (const char *p = data; p < data_end; ) {
+        const char *nl = (const char *) memchr(p, '\n', data_end - p);
+        const char *line_end = nl ? nl + 1 : data_end;
+        long long block_id = strtoll(p, NULL, 10);
+        if (block_id < 0 || block_id >= index_size || index[block_id] < 0) {
+            p = line_end;
+            continue;
+        }
+        long long chunk = chunk_of(index[block_id], origin, width) - first_chunk;
+        if (chunk != current) {
+            if (graph) {
+                if (chunk < current) {
+                    cerr << "Error: the transfer list is not sorted by block!\n";
+                    return 1;
+                }
+                // Flush the previous chunk and write the empty chunks in between.
+                for (long long c = max(current, 0LL); c < chunk; c++) {
+                    if (write_graph(edges, addresses, base_name, c, stats_file, chunk_start) < 0) {
+                        cerr << "Error: could not open chunk files!\n";
+                        return 1;
+                    }
+                    edges.clear();
+                    addresses.clear();
+                    node_ids.clear();
+                    chunk_start = high_resolution_clock::now();
+                }
+            }
+            else {
+                if (chunk_file) fclose(chunk_file);
+                string path = string(base_name) + "_" + to_string(chunk) + ".csv";
+                chunk_file = fopen(path.c_str(), created[chunk] ? "a" : "w");
+                if (!chunk_file) {
+                    cerr << "Error: could not open chunk file!\n";
+                    return 1;
+                }
+                setvbuf(chunk_file, buffer.data(), _IOFBF, buffer.size());
+                created[chunk] = 1;
+            }
+            current = chunk;
+        }
+        if (graph) {
+            // Fields: block, contract, sender, recipient, amount.
+            const char *q = (const char *) memchr(p, ',', line_end - p);
+            q = q ? (const char *) memchr(q + 1, ',', line_end - q - 1) : NULL;
+            if (q) {
+                char *r;
+                int from = strtol(q + 1, &r, 10);
+                int to = strtol(r + 1, &r, 10);
+                double value = strtod(r + 1, NULL);
+                // Transfers with sender = 0x0 (mint) or receiver = 0x0 (burn) are ignored.
+                // Self-transfers are also ignored.
+                if (from != 0 && to != 0 && from != to) {
+                    edge_t e;
+                    int ids[2] = {from, to};
+                    for (int k = 0; k < 2; k++) {
+                        auto it = node_ids.find(ids[k]);
+                        if (it == node_ids.end()) {
+                            it = node_ids.insert(make_pair(ids[k], (int) addresses.size())).first;
+                            addresses.push_back(ids[k]);
+                        }
+                        ids[k] = it->second;
+                    }
+                    e.from_id = ids[0];
+                    e.to_id = ids[1];
+                    e.value = value;
+                    edges.push_back(e);
+                }
+            }
+        }
+        else {
+            fwrite(p, 1, line_end - p, chunk_file);
+            if (!nl) fputc('\n', chunk_file);
+        }
+        p = line_end;
+    }
+
+    // Complete the last chunk and create the files of the empty chunks.
+    if (graph) {
+        for (long long c = max(current, 0LL); c < num_chunks; c++) {
+            if (write_graph(edges, addresses, base_name, c, stats_file, chunk_start) < 0) {
+                cerr << "Error: could not open chunk files!\n";
+                return 1;
+            }
+            edges.clear();
+            addresses.clear();
+            node_ids.clear();
+            chunk_start = high_resolution_clock::now();
+        }
+        fclose(stats_file);
+    }
+    else {
+        if (chunk_file) fclose(chunk_file);
+        for (long long c = 0; c < num_chunks; c++) {
+            if (created[c]) continue;
+            string path = string(base_name) + "_" + to_string(c) + ".csv";
+            FILE *f = fopen(path.c_str(), "w");
+            if (f) fclose(f);
+        }
+    }
+    unmap_file(&transfers);
+    unmap_file(&index_file);
+
+    // Print the number of chunks created.
+    cout << num_chunks << '\n';
+    return 0;
+}
@@ -0,0 +1,189 @@
+#!/bin/bash
+#
+#   This script runs the tools on the small inputs in tests/data and compares their output files
+#   with the expected ones in tests/expected. It also checks that invalid inputs are rejected.
+#
+#   INPUT:
+#   No input required from the user (the tools must be built first, e.g., with "make test").
+#
+#   OUTPUT:
+#   The script prints the result of each test and exits with a non-zero status if any test fails.
+#
+#   Author: Matteo Loporchio
+#
+
+DATA_PATH="./tests/data"
+EXPECTED_PATH="./tests/expected"
+OUTPUT_PATH=$(mktemp -d)
+NUM_FAILED=0
+
+trap 'rm -rf ${OUTPUT_PATH}' EXIT
+
+# Compares an output file with the expected one.
+expect_same() {
+    if cmp -s "${EXPECTED_PATH}/$1" "${OUTPUT_PATH}/$1"; then
+        echo "PASS: $1"
+    else
+        echo "FAIL: $1"
+        NUM_FAILED=$((NUM_FAILED + 1))
+    fi
+}
+
+# Checks that two output files are identical (the first argument is the name of the test).
+expect_identical() {
+    if cmp -s "${OUTPUT_PATH}/$2" "${OUTPUT_PATH}/$3"; then
+        echo "PASS: $1"
+    else
+        echo "FAIL: $1"
+        NUM_FAILED=$((NUM_FAILED + 1))
+    fi
+}
+
+# Checks that a command reports an error and exits with status 1, so that crashes are not accepted
+# (the first argument is the name of the test).
+expect_failure() {
+    local name=$1
+    shift
+    "$@" > /dev/null 2>&1
+    if [ $? -ne 1 ]; then
+        echo "FAIL: ${name}"
+        NUM_FAILED=$((NUM_FAILED + 1))
+    else
+        echo "PASS: ${name}"
+    fi
+}
+
+# window_degree
+./window_degree ${DATA_PATH}/transfers.csv ${OUTPUT_PATH}/window_degree.tsv 120 60 > /dev/null
+expect_same window_degree.tsv
+expect_failure window_degree_unsorted ./window_degree ${DATA_PATH}/transfers_unsorted.csv ${OUTPUT_PATH}/unsorted.tsv 120 60
+
+# cg_triangles
+./cg_triangles ${DATA_PATH}/cg_el.tsv ${OUTPUT_PATH}/cg_triangles.tsv > /dev/null
+expect_same cg_triangles.tsv
+
+# cg_communities (a single thread, since concurrent moves depend on scheduling)
+OMP_NUM_THREADS=1 ./cg_communities ${DATA_PATH}/cg_el.tsv ${OUTPUT_PATH}/cg_communities.tsv ${OUTPUT_PATH}/levels.tsv ntr > /dev/null
+cut -f1-3 ${OUTPUT_PATH}/levels.tsv > ${OUTPUT_PATH}/cg_communities_levels.tsv
+expect_same cg_communities.tsv
+expect_same cg_communities_levels.tsv
+expect_failure cg_communities_weight ./cg_communities ${DATA_PATH}/cg_el.tsv ${OUTPUT_PATH}/c.tsv ${OUTPUT_PATH}/l.tsv weight
+
+# cg_kcore
+./cg_kcore ${DATA_PATH}/cg_el.tsv ${OUTPUT_PATH}/cg_kcore.tsv ${OUTPUT_PATH}/cg_kcore_distribution.tsv > /dev/null
+expect_same cg_kcore.tsv
+expect_same cg_kcore_distribution.tsv
+
+# cg_betweenness (the estimates only depend on the seed, not on the number of threads)
+./cg_betweenness ${DATA_PATH}/cg_el.tsv ${OUTPUT_PATH}/cg_betweenness.tsv exact > /dev/null
+expect_same cg_betweenness.tsv
+OMP_NUM_THREADS=1 ./cg_betweenness ${DATA_PATH}/cg_el.tsv ${OUTPUT_PATH}/sample_1.tsv 0.1 0.1 42 > /dev/null
+OMP_NUM_THREADS=4 ./cg_betweenness ${DATA_PATH}/cg_el.tsv ${OUTPUT_PATH}/sample_4.tsv 0.1 0.1 42 > /dev/null
+expect_identical cg_betweenness_seed sample_1.tsv sample_4.tsv
+expect_failure cg_betweenness_epsilon ./cg_betweenness ${DATA_PATH}/cg_el.tsv ${OUTPUT_PATH}/b.tsv 1.5
+
+# partition
+mkdir -p ${OUTPUT_PATH}/partition
+./partition ${DATA_PATH}/erc20.csv ${DATA_PATH}/erc20_values.csv ${DATA_PATH}/contracts.tsv ${OUTPUT_PATH}/partition > /dev/null
+expect_same partition/token_a.csv
+expect_same partition/token_b.csv
+expect_same partition/token_c.csv
+expect_failure partition_duplicate ./partition ${DATA_PATH}/erc20.csv ${DATA_PATH}/erc20_values.csv ${DATA_PATH}/contracts_duplicate.tsv ${OUTPUT_PATH}/partition
+
+# ts_index and temporal_chunker (chunks are aligned as in pandas)
+mkdir -p ${OUTPUT_PATH}/chunks
+./ts_index ${DATA_PATH}/blocks.csv ${OUTPUT_PATH}/blocks.idx > /dev/null
+./temporal_chunker ${DATA_PATH}/erc20.csv ${OUTPUT_PATH}/blocks.idx ${OUTPUT_PATH}/chunks/m ${OUTPUT_PATH}/chunks/m_map.tsv 3M > /dev/null
+./temporal_chunker ${DATA_PATH}/erc20.csv ${OUTPUT_PATH}/blocks.idx ${OUTPUT_PATH}/chunks/d ${OUTPUT_PATH}/chunks/d_map.tsv 30D > /dev/null
+for i in 0 1 2 3; do
+    expect_same chunks/m_${i}.csv
+done
+expect_same chunks/m_map.tsv
+expect_same chunks/d_map.tsv
+expect_failure temporal_chunker_width ./temporal_chunker ${DATA_PATH}/erc20.csv ${OUTPUT_PATH}/blocks.idx ${OUTPUT_PATH}/chunks/w ${OUTPUT_PATH}/chunks/w_map.tsv 3W
+
+# Compressed input (the gzip files are created from the plain fixture)
+gzip -nc ${DATA_PATH}/cg_el.tsv > ${OUTPUT_PATH}/cg_el.tsv.gz
+(head -n 8 ${DATA_PATH}/cg_el.tsv | gzip -nc; tail -n +9 ${DATA_PATH}/cg_el.tsv | gzip -nc) > ${OUTPUT_PATH}/multi.tsv.gz
+head -c 60 ${OUTPUT_PATH}/cg_el.tsv.gz > ${OUTPUT_PATH}/truncated.tsv.gz
+cp ${OUTPUT_PATH}/cg_el.tsv.gz ${OUTPUT_PATH}/corrupted.tsv.gz
+printf 'XXXXXXXX' | dd of=${OUTPUT_PATH}/corrupted.tsv.gz bs=1 seek=40 conv=notrunc 2> /dev/null
+printf '\x1f\x8b' > ${OUTPUT_PATH}/magic.tsv.gz
+./cg_triangles ${OUTPUT_PATH}/cg_el.tsv.gz ${OUTPUT_PATH}/gzip.tsv > /dev/null
+./cg_triangles ${OUTPUT_PATH}/multi.tsv.gz ${OUTPUT_PATH}/multi.tsv > /dev/null
+gzip -dc ${OUTPUT_PATH}/cg_el.tsv.gz | ./cg_triangles /dev/stdin ${OUTPUT_PATH}/pipe.tsv > /dev/null
+expect_identical gzip cg_triangles.tsv gzip.tsv
+expect_identical gzip_multi_member cg_triangles.tsv multi.tsv
+expect_identical plain_pipe cg_triangles.tsv pipe.tsv
+expect_failure gzip_truncated ./cg_triangles ${OUTPUT_PATH}/truncated.tsv.gz ${OUTPUT_PATH}/t.tsv
+expect_failure gzip_corrupted ./cg_triangles ${OUTPUT_PATH}/corrupted.tsv.gz ${OUTPUT_PATH}/t.tsv
+expect_failure gzip_magic_only ./cg_triangles ${OUTPUT_PATH}/magic.tsv.gz ${OUTPUT_PATH}/t.tsv
+
+# mg_topk (the summaries are large enough for exact counts)
+./mg_topk ${DATA_PATH}/mg_el.tsv ${OUTPUT_PATH}/mg_topk 3 > /dev/null
+for quantity in in_str out_str pair_amount pair_ntr; do
+    expect_same mg_topk_${quantity}.tsv
+done
+gzip -nc ${DATA_PATH}/mg_el.tsv > ${OUTPUT_PATH}/mg_el.tsv.gz
+head -c 60 ${OUTPUT_PATH}/mg_el.tsv.gz > ${OUTPUT_PATH}/mg_truncated.tsv.gz
+./mg_topk ${OUTPUT_PATH}/mg_el.tsv.gz ${OUTPUT_PATH}/mg_topk_gzip 3 > /dev/null
+expect_identical mg_topk_gzip mg_topk_pair_amount.tsv mg_topk_gzip_pair_amount.tsv
+cat ${DATA_PATH}/mg_el.tsv | ./mg_topk /dev/stdin ${OUTPUT_PATH}/mg_topk_pipe 3 > /dev/null
+cat ${OUTPUT_PATH}/mg_el.tsv.gz | ./mg_topk /dev/stdin ${OUTPUT_PATH}/mg_topk_gzip_pipe 3 > /dev/null
+expect_identical mg_topk_pipe mg_topk_pair_amount.tsv mg_topk_pipe_pair_amount.tsv
+expect_identical mg_topk_gzip_pipe mg_topk_pair_amount.tsv mg_topk_gzip_pipe_pair_amount.tsv
+expect_failure mg_topk_width ./mg_topk ${DATA_PATH}/mg_el.tsv ${OUTPUT_PATH}/mg_topk_width 3 64 0
+expect_failure mg_topk_depth ./mg_topk ${DATA_PATH}/mg_el.tsv ${OUTPUT_PATH}/mg_topk_depth 3 64 1024 -1
+expect_failure mg_topk_truncated ./mg_topk ${OUTPUT_PATH}/mg_truncated.tsv.gz ${OUTPUT_PATH}/mg_topk_truncated 3
+
+# nm_build and nm_remap (translating the node identifiers of an output must give the same result as the node map option)
+./nm_build ${OUTPUT_PATH}/cg.nm ${DATA_PATH}/cg_nm.tsv > /dev/null
+./nm_build ${OUTPUT_PATH}/global.nm ${DATA_PATH}/global_nm.tsv > /dev/null
+./cg_triangles ${DATA_PATH}/cg_el.tsv ${OUTPUT_PATH}/cg_triangles_address.tsv ${OUTPUT_PATH}/cg.nm > /dev/null
+./nm_remap ${OUTPUT_PATH}/cg_triangles.tsv ${OUTPUT_PATH}/remap_address.tsv ${OUTPUT_PATH}/cg.nm - > /dev/null
+./nm_remap ${OUTPUT_PATH}/cg_triangles.tsv ${OUTPUT_PATH}/nm_remap_global.tsv ${OUTPUT_PATH}/cg.nm ${OUTPUT_PATH}/global.nm > /dev/null
+./nm_remap ${OUTPUT_PATH}/mg_topk_pair_ntr.tsv ${OUTPUT_PATH}/nm_remap_pairs.tsv ${OUTPUT_PATH}/cg.nm - 2 > /dev/null
+expect_same cg_triangles_address.tsv
+expect_identical nm_remap_address cg_triangles_address.tsv remap_address.tsv
+expect_same nm_remap_global.tsv
+expect_same nm_remap_pairs.tsv
+expect_failure node_map_invalid ./cg_triangles ${DATA_PATH}/cg_el.tsv ${OUTPUT_PATH}/t.tsv ${DATA_PATH}/cg_el.tsv
+# Valid magic number, but the number of nodes (2^62) overflows the offset of the index.
+head -c 8 ${OUTPUT_PATH}/cg.nm > ${OUTPUT_PATH}/huge.nm
+printf '\x00\x00\x00\x00\x00\x00\x00\x40\x00\x00\x00\x00\x00\x00\x00\x00' >> ${OUTPUT_PATH}/huge.nm
+expect_failure node_map_too_many_nodes ./cg_triangles ${DATA_PATH}/cg_el.tsv ${OUTPUT_PATH}/t.tsv ${OUTPUT_PATH}/huge.nm
+
+# cg_harmonic, cg_distance and cg_merge (checkpoints)
+./cg_harmonic ${DATA_PATH}/cg_el.tsv ${OUTPUT_PATH}/cg_harmonic.tsv > /dev/null
+./cg_distance ${DATA_PATH}/cg_el.tsv | cut -f1-3 > ${OUTPUT_PATH}/cg_distance.tsv
+expect_same cg_harmonic.tsv
+expect_same cg_distance.tsv
+# Two ranges processed independently and merged, or resumed from the checkpoint of the first range.
+./cg_harmonic ${DATA_PATH}/cg_el.tsv ${OUTPUT_PATH}/h.tsv - ${OUTPUT_PATH}/first.ckpt 0 4 > /dev/null
+./cg_harmonic ${DATA_PATH}/cg_el.tsv ${OUTPUT_PATH}/h.tsv - ${OUTPUT_PATH}/second.ckpt 4 > /dev/null
+./cg_merge ${OUTPUT_PATH}/merged.ckpt ${OUTPUT_PATH}/first.ckpt ${OUTPUT_PATH}/second.ckpt > /dev/null
+./cg_harmonic ${DATA_PATH}/cg_el.tsv ${OUTPUT_PATH}/merged.tsv - ${OUTPUT_PATH}/merged.ckpt > /dev/null
+expect_identical checkpoint_merge cg_harmonic.tsv merged.tsv
+cp ${OUTPUT_PATH}/first.ckpt ${OUTPUT_PATH}/resumed.ckpt
+./cg_harmonic ${DATA_PATH}/cg_el.tsv ${OUTPUT_PATH}/resumed.tsv - ${OUTPUT_PATH}/resumed.ckpt > /dev/null
+expect_identical checkpoint_resume cg_harmonic.tsv resumed.tsv
+./cg_distance ${DATA_PATH}/cg_el.tsv ${OUTPUT_PATH}/distance.ckpt 0 3 > /dev/null
+./cg_distance ${DATA_PATH}/cg_el.tsv ${OUTPUT_PATH}/distance.ckpt | cut -f1-3 > ${OUTPUT_PATH}/resumed_distance.tsv
+expect_identical checkpoint_resume_distance cg_distance.tsv resumed_distance.tsv
+# Invalid checkpoints are rejected and left untouched.
+head -c 40 ${OUTPUT_PATH}/merged.ckpt > ${OUTPUT_PATH}/truncated.ckpt
+cp ${OUTPUT_PATH}/truncated.ckpt ${OUTPUT_PATH}/truncated_copy.ckpt
+cp ${DATA_PATH}/cg_el.tsv ${OUTPUT_PATH}/other.ckpt
+cp ${DATA_PATH}/cg_el.tsv ${OUTPUT_PATH}/other_copy.ckpt
+expect_failure checkpoint_truncated ./cg_harmonic ${DATA_PATH}/cg_el.tsv ${OUTPUT_PATH}/h.tsv - ${OUTPUT_PATH}/truncated.ckpt
+expect_identical checkpoint_truncated_untouched truncated.ckpt truncated_copy.ckpt
+expect_failure checkpoint_other_file ./cg_harmonic ${DATA_PATH}/cg_el.tsv ${OUTPUT_PATH}/h.tsv - ${OUTPUT_PATH}/other.ckpt
+expect_identical checkpoint_other_file_untouched other.ckpt other_copy.ckpt
+expect_failure checkpoint_kind ./cg_harmonic ${DATA_PATH}/cg_el.tsv ${OUTPUT_PATH}/h.tsv - ${OUTPUT_PATH}/distance.ckpt
+expect_failure checkpoint_range ./cg_distance ${DATA_PATH}/cg_el.tsv ${OUTPUT_PATH}/range.ckpt 5 5
+
+if [ ${NUM_FAILED} -gt 0 ]; then
+    echo "${NUM_FAILED} test(s) failed!"
+    exit 1
+fi
+echo "All tests passed."
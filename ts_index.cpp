@@ -0,0 +1,79 @@
+/**
+ * @file ts_index.cpp
+ * @author Matteo Loporchio
+ * @date 2025-06-24
+ *
+ *  This program converts the list of block timestamps into a binary index,
+ *  so that the timestamp of a block can be found in constant time by memory-mapping the index.
+ *  The index is a dense array of 64-bit integers (in native byte order) where the i-th element
+ *  is the timestamp of block i, or -1 if the timestamp of the block is unknown.
+ *
+ *  INPUT:
+ *  The program requires the following arguments:
+ *      1. The path to the block timestamp list, i.e., a CSV file where each row includes:
+ *          - block identifier;
+ *          - timestamp of the block (in seconds).
+ *      2. The path to the output index file.
+ *
+ *  PRINT:
+ *  The program prints the following information to stdout:
+ *      - number of entries of the index (i.e., largest block identifier plus one);
+ *      - elapsed time (in nanoseconds).
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include "io.hpp"
+
+using namespace std;
+using namespace std::chrono;
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        cerr << "Usage: " << argv[0] << " <timestamp_file> <index_file>\n";
+        return 1;
+    }
+
+    auto start = high_resolution_clock::now();
+
+    mapped_file_t input;
+    if (map_file(argv[1], &input) < 0) {
+        cerr << "Error: could not open input file!\n";
+        return 1;
+    }
+    vector<int64_t> index;
+    const char *p = input.data, *end = input.data + input.size;
+    while (p < end) {
+        const char *nl = (const char *) memchr(p, '\n', end - p);
+        if (!nl) nl = end;
+        char *q;
+        long block_id = strtol(p, &q, 10);
+        if (q < nl && *q == ',' && block_id >= 0) {
+            int64_t timestamp = strtoll(q + 1, NULL, 10);
+            if ((size_t) block_id >= index.size()) index.resize(block_id + 1, -1);
+            index[block_id] = timestamp;
+        }
+        p = nl + 1;
+    }
+    unmap_file(&input);
+
+    FILE *output_file = fopen(argv[2], "wb");
+    if (!output_file) {
+        cerr << "Error: could not open output file!\n";
+        return 1;
+    }
+    fwrite(index.data(), sizeof(int64_t), index.size(), output_file);
+    fclose(output_file);
+
+    auto stop = high_resolution_clock::now();
+    auto elapsed = duration_cast<nanoseconds>(stop - start);
+
+    // Print information about the program execution.
+    cout << index.size() << '\t' << elapsed.count() << '\n';
+    return 0;
+}
@@ -0,0 +1,246 @@
+/**
+ * @file window_degree.cpp
+ * @author Matteo Loporchio
+ * @date 2025-05-12
+ *
+ *  This program reads a time-ordered ERC-20 transfer list and computes, in a single pass,
+ *  the degree and strength of each address over a sliding time window.
+ *  The window has a fixed width and is sampled at regular steps: for each sampling instant t,
+ *  the window covers all transfers with timestamp in [t - width, t).
+ *  Sampling instants are aligned to multiples of the step.
+ *
+ *  Degrees and strengths are the same quantities computed by cg_degree on the collapsed graph
+ *  built from the transfers in the window, i.e., the in-degree (out-degree) of an address is
+ *  the number of distinct senders (recipients) it exchanged tokens with inside the window.
+ *  The counters of each address are updated incrementally as transfers enter and leave the window,
+ *  hence the total cost is proportional to the number of transfers and not to the number of windows.
+ *  As in the collapsed graph, mint and burn transfers, as well as self-transfers, are ignored.
+ *
+ *  INPUT:
+ *  The program requires the following arguments:
+ *      1. The path to the transfer list, i.e., a CSV file sorted by timestamp where each row includes:
+ *          - block identifier in which the transfer occurred;
+ *          - numeric identifier of the contract that produced the event;
+ *          - numeric identifier of the sender of the transfer;
+ *          - numeric identifier of the recipient of the transfer;
+ *          - amount of tokens transferred;
+ *          - timestamp of the block (in seconds).
+ *      2. The path to the output file.
+ *      3. The width of the window (in seconds).
+ *      4. The step between two consecutive windows (in seconds).
+ *
+ *  OUTPUT:
+ *  A sparse TSV file with one snapshot for each window. A snapshot only contains the addresses
+ *  whose counters changed since the previous window (addresses that left the window are reported
+ *  once, with all counters set to zero). Each line includes the following fields:
+ *      - sampling instant (i.e., right endpoint of the window);
+ *      - numeric identifier of the address (as in the transfer list);
+ *      - in-degree of the address;
+ *      - out-degree of the address;
+ *      - in-strength of the address (computed according to total number of transfers);
+ *      - out-strength of the address (computed according to total number of transfers);
+ *      - in-strength of the address (computed according to total amount transferred);
+ *      - out-strength of the address (computed according to total amount transferred).
+ *
+ *  PRINT:
+ *  The program prints the following information to stdout:
+ *      - number of transfers in the window computation;
+ *      - number of windows written to the output file;
+ *      - elapsed time (in nanoseconds).
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+/**
+ * @brief A transfer currently inside the window.
+ */
+typedef struct {
+    long long timestamp;
+    int from;
+    int to;
+    double amount;
+} transfer_t;
+
+/**
+ * @brief Degree and strength counters of an address inside the window.
+ */
+typedef struct {
+    int in_deg;
+    int out_deg;
+    long long in_ntr;
+    long long out_ntr;
+    double in_amount;
+    double out_amount;
+    bool dirty;
+} counters_t;
+
+unordered_map<int, counters_t> nodes; // counters of the addresses inside the window
+unordered_map<uint64_t, int> pairs; // number of transfers for each (sender, recipient) pair
+deque<transfer_t> window; // transfers inside the window, in timestamp order
+vector<int> dirty; // addresses whose counters changed since the last snapshot
+
+/**
+ * @brief Returns the key associated with the (from, to) pair.
+ */
+static inline uint64_t pair_key(int from, int to) {
+    return ((uint64_t) (uint32_t) from << 32) | (uint32_t) to;
+}
+
+/**
+ * @brief Returns the counters of an address, marking them as changed.
+ */
+static inline counters_t &touch(int address) {
+    counters_t &c = nodes[address];
+    if (!c.dirty) {
+        c.dirty = true;
+        dirty.push_back(address);
+    }
+    return c;
+}
+
+/**
+ * @brief Updates the counters when a transfer enters (sign = 1) or leaves (sign = -1) the window.
+ */
+static void update(const transfer_t &t, int sign) {
+    int &count = pairs[pair_key(t.from, t.to)];
+    int new_edge = 0;
+    if (sign > 0 && count == 0) new_edge = 1;
+    count += sign;
+    if (sign < 0 && count == 0) {
+        new_edge = -1;
+        pairs.erase(pair_key(t.from, t.to));
+    }
+    counters_t &u = touch(t.from);
+    u.out_deg += new_edge;
+    u.out_ntr += sign;
+    u.out_amount += sign * t.amount;
+    counters_t &v = touch(t.to);
+    v.in_deg += new_edge;
+    v.in_ntr += sign;
+    v.in_amount += sign * t.amount;
+}
+
+/**
+ * @brief Removes the expired transfers and writes the snapshot of the window ending at a given instant.
+ *
+ * @param output_file the output file
+ * @param end right endpoint of the window
+ * @param width width of the window
+ */
+static void emit_window(FILE *output_file, long long end, long long width) {
+    while (!window.empty() && window.front().timestamp < end - width) {
+        update(window.front(), -1);
+        window.pop_front();
+    }
+    sort(dirty.begin(), dirty.end());
+    for (int address : dirty) {
+        auto it = nodes.find(address);
+        counters_t &c = it->second;
+        // Amounts are reset explicitly to avoid reporting floating-point residuals.
+        bool empty = (c.in_ntr == 0 && c.out_ntr == 0);
+        if (empty) c.in_amount = c.out_amount = 0.0;
+        fprintf(output_file, "%lld\t%d\t%d\t%d\t%lld\t%lld\t%lf\t%lf\n", end, address,
+        c.in_deg, c.out_deg, c.in_ntr, c.out_ntr, c.in_amount, c.out_amount);
+        c.dirty = false;
+        if (empty) nodes.erase(it);
+    }
+    dirty.clear();
+}
+
+int main(int argc, char **argv) {
+    if (argc < 5) {
+        cerr << "Usage: " << argv[0] << " <input_file> <output_file> <window_size> <step>\n";
+        return 1;
+    }
+    long long width = atoll(argv[3]);
+    long long step = atoll(argv[4]);
+    if (width <= 0 || step <= 0) {
+        cerr << "Error: window size and step must be positive!\n";
+        return 1;
+    }
+
+    auto start = high_resolution_clock::now();
+
+    FILE *input_file = fopen(argv[1], "r");
+    if (!input_file) {
+        cerr << "Error: could not open input file!\n";
+        return 1;
+    }
+    FILE *output_file = fopen(argv[2], "w");
+    if (!output_file) {
+        cerr << "Error: could not open output file!\n";
+        return 1;
+    }
+    fprintf(output_file, "window_end\tnode_id\tin_deg\tout_deg\tin_str_ntr\tout_str_ntr\tin_str_amount\tout_str_amount\n");
+
+    long long num_transfers = 0;
+    long long num_windows = 0;
+    long long next_end = 0;
+    long long last_timestamp = 0;
+    bool started = false;
+    char *line_buf = NULL;
+    size_t line_size = 0;
+    while (getline(&line_buf, &line_size, input_file) > 0) {
+        // Fields: block, contract, sender, recipient, amount, timestamp.
+        char *p = line_buf;
+        strtol(p, &p, 10); p++;
+        strtol(p, &p, 10); p++;
+        int from = strtol(p, &p, 10); p++;
+        int to = strtol(p, &p, 10); p++;
+        double amount = strtod(p, &p); p++;
+        long long timestamp = strtoll(p, &p, 10);
+        if (started && timestamp < last_timestamp) {
+            cerr << "Error: the transfer list is not sorted by timestamp!\n";
+            return 1;
+        }
+        last_timestamp = timestamp;
+        if (!started) {
+            next_end = (timestamp / step + 1) * step;
+            started = true;
+        }
+        // Close all windows ending before the current transfer.
+        while (timestamp >= next_end) {
+            emit_window(output_file, next_end, width);
+            num_windows++;
+            next_end += step;
+            // Skip the windows in which nothing happens.
+            if (window.empty() && dirty.empty() && timestamp >= next_end)
+                next_end = (timestamp / step + 1) * step;
+        }
+        // Transfers with sender = 0x0 (mint) or receiver = 0x0 (burn) are ignored.
+        // Self-transfers are also ignored.
+        if (from == 0 || to == 0 || from == to) continue;
+        transfer_t t = {timestamp, from, to, amount};
+        window.push_back(t);
+        update(t, 1);
+        num_transfers++;
+    }
+    free(line_buf);
+    fclose(input_file);
+
+    // Drain the window after the last transfer.
+    while (!window.empty() || !dirty.empty()) {
+        emit_window(output_file, next_end, width);
+        num_windows++;
+        next_end += step;
+    }
+    fclose(output_file);
+
+    auto end = high_resolution_clock::now();
+    auto elapsed = duration_cast<nanoseconds>(end - start);
+
+    // Print information about the program execution.
+    cout << num_transfers << '\t' << num_windows << '\t' << elapsed.count() << '\n';
+    return 0;
+}